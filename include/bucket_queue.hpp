@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+/// A priority queue of elements with small integral priorities in [0, bucketCount), with the
+/// element indexed interface of indexed_heap.
+///
+/// Every priority has a bucket, which is an intrusive circular doubly-linked list threaded through
+/// flat arrays: nodes [0, itemCount) are the elements, nodes [itemCount, itemCount + bucketCount)
+/// are the bucket sentinels. Nothing is allocated after construction, push, pop and priority
+/// changes are O(1). The lowest bucket is only kept as a lower bound, top() and pop() scan forward
+/// from it to the first non-empty bucket: amortized O(1) while priorities do not drop below the
+/// last top priority (Dijkstra, event simulation), up to bucketCount steps after an emptied lowest
+/// bucket otherwise. top() advances the bound although it is const, concurrent readers need a lock.
+/// Elements of equal priority are popped in insertion order.
+template<typename elem_type, typename prio_type>
+class bucket_queue
+{
+    public:
+        static_assert(std::is_integral<elem_type>::value, "bucket_queue: elem_type must be integral");
+        static_assert(std::is_unsigned<elem_type>::value, "bucket_queue: elem_type must be unsigned");
+        static_assert(std::is_integral<prio_type>::value, "bucket_queue: prio_type must be integral");
+        using index_type = std::make_unsigned_t<elem_type>;
+
+        bucket_queue(elem_type itemCount, size_t bucketCount)
+            : mItemCount(itemCount)
+            , mBucketCount(bucketCount)
+            , mMinBucket(bucketCount)
+        {
+            if (bucketCount > std::numeric_limits<index_type>::max() - static_cast<size_t>(itemCount))
+                throw std::length_error("bucket_queue: itemCount + bucketCount exceeds elem_type");
+
+            const index_type nodeCount = itemCount + static_cast<index_type>(bucketCount);
+            mNext.resize(nodeCount);
+            mPrev.resize(nodeCount);
+            mPrio.resize(itemCount);
+
+            // every element and bucket sentinel starts out linked to itself
+            for (index_type node = 0; node < nodeCount; ++node)
+                mNext[node] = mPrev[node] = node;
+        }
+
+        size_t size() const
+        { return mSize; }
+
+        bool empty() const
+        { return mSize == 0; }
+
+        size_t bucket_count() const
+        { return mBucketCount; }
+
+        elem_type top() const
+        {
+            if (empty())
+                throw std::out_of_range("bucket_queue::top(): empty queue");
+            return mNext[sentinel(min_bucket())];
+        }
+
+        prio_type top_priority() const
+        {
+            if (empty())
+                throw std::out_of_range("bucket_queue::top_priority(): empty queue");
+            return static_cast<prio_type>(min_bucket());
+        }
+
+        void pop()
+        {
+            if (empty())
+                return;
+
+            unlink(mNext[sentinel(min_bucket())]);
+            --mSize;
+        }
+
+        bool push(const elem_type elem, const prio_type priority)
+        {
+            if (is_queued(elem))
+                return false;
+
+            link(elem, checked_bucket(priority));
+            mPrio[elem] = priority;
+            ++mSize;
+            return true;
+        }
+
+        prio_type get_priority(const elem_type elem) const
+        {
+            if (!is_queued(elem))
+                throw std::out_of_range("bucket_queue::get_priority(): element not queued");
+            return mPrio[elem];
+        }
+
+        bool change_priority(const elem_type elem, const prio_type priority)
+        {
+            if (!is_queued(elem))
+                return false;
+
+            if (priority == mPrio[elem])
+                return true;
+
+            const size_t bucket = checked_bucket(priority);
+            unlink(elem);
+            link(elem, bucket);
+            mPrio[elem] = priority;
+            return true;
+        }
+
+        void set_priority(const elem_type elem, const prio_type priority)
+        {
+            if (!change_priority(elem, priority))
+                push(elem, priority);
+        }
+
+    protected:
+
+        index_type sentinel(size_t bucket) const
+        { return mItemCount + static_cast<index_type>(bucket); }
+
+        bool is_queued(const elem_type elem) const
+        {
+            if (elem >= mItemCount)
+                throw std::out_of_range("bucket_queue: element out of range");
+            return mNext[elem] != elem;
+        }
+
+        size_t checked_bucket(const prio_type priority) const
+        {
+            // negative priorities wrap around to huge values
+            const auto bucket = static_cast<std::make_unsigned_t<prio_type>>(priority);
+            if (bucket >= mBucketCount)
+                throw std::out_of_range("bucket_queue: priority out of range");
+            return bucket;
+        }
+
+        void link(const index_type elem, const size_t bucket)
+        {
+            const index_type head = sentinel(bucket);
+            const index_type last = mPrev[head];
+            mNext[last] = elem;
+            mPrev[elem] = last;
+            mNext[elem] = head;
+            mPrev[head] = elem;
+
+            if (bucket < mMinBucket)
+                mMinBucket = bucket;
+        }
+
+        void unlink(const index_type elem)
+        {
+            mNext[mPrev[elem]] = mNext[elem];
+            mPrev[mNext[elem]] = mPrev[elem];
+            mNext[elem] = mPrev[elem] = elem;
+        }
+
+        /// Lowest non-empty bucket, the queue must not be empty
+        size_t min_bucket() const
+        {
+            while (mNext[sentinel(mMinBucket)] == sentinel(mMinBucket))
+                ++mMinBucket;
+            return mMinBucket;
+        }
+
+        index_type mItemCount;
+        size_t mBucketCount;
+        mutable size_t mMinBucket; // no non-empty bucket below it, advanced by min_bucket()
+        size_t mSize = 0;
+        std::vector<index_type> mNext; // next node in the bucket list by node
+        std::vector<index_type> mPrev; // previous node in the bucket list by node
+        std::vector<prio_type> mPrio; // priority by element
+};
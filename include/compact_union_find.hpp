@@ -0,0 +1,264 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/// Space optimized union-find for huge, mostly singleton element sets.
+///
+/// Parents are stored as packed `parent_bits` wide words, and storage is allocated lazily in chunks
+/// of `chunkSize` elements: a chunk is only allocated once one of its elements is linked under
+/// another root or becomes the root of a non-singleton set. Untouched chunks cost a null pointer.
+/// Sets are joined by rank (a byte per element) instead of by size.
+template<unsigned parent_bits = 40>
+class compact_union_find
+{
+    public:
+
+        static_assert(parent_bits % 8 == 0, "compact_union_find: parent_bits must be whole bytes");
+        static_assert(parent_bits >= 16 && parent_bits <= 56, "compact_union_find: parent_bits must be in [16, 56]");
+
+        using value_type = uint64_t;
+        using size_type = uint64_t;
+
+        static constexpr unsigned parentBytes = parent_bits / 8;
+        static constexpr unsigned chunkBits = 16;
+        static constexpr size_type chunkSize = size_type(1) << chunkBits;
+        static constexpr size_type maxSize = (size_type(1) << parent_bits) - 1;
+
+        compact_union_find(size_type n)
+        {
+            resize(n);
+        }
+
+        value_type max_value() const
+        {
+            return mSize - 1;
+        }
+
+        size_type size() const
+        {
+            return mSize;
+        }
+
+        void resize(size_type n)
+        {
+            if (n < size())
+                throw std::out_of_range("compact_union_find::resize() cannot shrink size");
+            if (n > maxSize)
+                throw std::length_error("compact_union_find::resize() size exceeds parent_bits");
+
+            mSize = n;
+            mChunks.resize((n + chunkSize - 1) >> chunkBits);
+        }
+
+        bool join(value_type v1, value_type v2)
+        {
+            auto r1 = find(v1);
+            auto r2 = find(v2);
+
+            if (r1 == r2)
+                return false;
+
+            auto rank1 = rank(r1);
+            auto rank2 = rank(r2);
+
+            if (rank1 < rank2)
+            {
+                std::swap(r1, r2);
+                std::swap(rank1, rank2);
+            }
+
+            set_parent(r2, r1);
+            if (rank1 == rank2)
+                set_rank(r1, rank1 + 1);
+
+            return true;
+        }
+
+        value_type find(value_type value) const
+        {
+            if (value >= size())
+                throw std::out_of_range("compact_union_find::find(): value out of range");
+
+            value_type root = value;
+            value_type parentOfRoot;
+            while ((parentOfRoot = parent(root)) != root)
+                root = parentOfRoot;
+
+            return root;
+        }
+
+        value_type find_opt(value_type value)
+        {
+            auto root = static_cast<const compact_union_find&>(*this).find(value);
+            compress_path(value, root);
+            return root;
+        }
+
+        value_type find(value_type value)
+        {
+            return find_opt(value);
+        }
+
+        size_type count_disjoint() const
+        {
+            size_type roots = 0;
+            for (size_type c = 0; c < mChunks.size(); ++c)
+            {
+                const auto* chunk = mChunks[c].get();
+                const auto count = chunk_elements(c);
+                if (!chunk)
+                {
+                    roots += count;
+                    continue;
+                }
+
+                for (size_type i = 0; i < count; ++i)
+                {
+                    if (load(chunk->parents + i * parentBytes) == 0)
+                        ++roots;
+                }
+            }
+            return roots;
+        }
+
+        size_type count_singleton() const
+        {
+            size_type singletons = 0;
+            for (size_type c = 0; c < mChunks.size(); ++c)
+            {
+                const auto* chunk = mChunks[c].get();
+                const auto count = chunk_elements(c);
+                if (!chunk)
+                {
+                    singletons += count;
+                    continue;
+                }
+
+                // with union by rank only roots that never got a child have rank 0
+                for (size_type i = 0; i < count; ++i)
+                {
+                    if (load(chunk->parents + i * parentBytes) == 0 && chunk->ranks[i] == 0)
+                        ++singletons;
+                }
+            }
+            return singletons;
+        }
+
+        size_type allocated_chunks() const
+        {
+            return mAllocatedChunks;
+        }
+
+        /// Bytes of heap and object storage currently used.
+        size_type memory_usage() const
+        {
+            return sizeof(*this) +
+                mChunks.capacity() * sizeof(typename decltype(mChunks)::value_type) +
+                mAllocatedChunks * sizeof(chunk_type);
+        }
+
+    protected:
+
+        struct chunk_type
+        {
+            uint8_t parents[chunkSize * parentBytes]; // parent + 1, or 0 for roots
+            uint8_t ranks[chunkSize];
+        };
+
+        static value_type load(const uint8_t* word)
+        {
+            value_type v = 0;
+            for (unsigned b = 0; b < parentBytes; ++b)
+                v |= static_cast<value_type>(word[b]) << (8 * b);
+            return v;
+        }
+
+        static void store(uint8_t* word, value_type v)
+        {
+            for (unsigned b = 0; b < parentBytes; ++b)
+                word[b] = static_cast<uint8_t>(v >> (8 * b));
+        }
+
+        size_type chunk_elements(size_type c) const
+        {
+            const auto first = c << chunkBits;
+            return mSize - first < chunkSize ? mSize - first : chunkSize;
+        }
+
+        chunk_type& chunk_of(value_type value)
+        {
+            auto& chunk = mChunks[value >> chunkBits];
+            if (!chunk)
+            {
+                chunk.reset(new chunk_type()); // zero filled: all roots of rank 0
+                ++mAllocatedChunks;
+            }
+            return *chunk;
+        }
+
+        value_type parent(value_type value) const
+        {
+            const auto* chunk = mChunks[value >> chunkBits].get();
+            if (!chunk)
+                return value;
+
+            const auto word = load(chunk->parents + (value & (chunkSize - 1)) * parentBytes);
+            return word == 0 ? value : word - 1;
+        }
+
+        void set_parent(value_type value, value_type newParent)
+        {
+            store(chunk_of(value).parents + (value & (chunkSize - 1)) * parentBytes, newParent + 1);
+        }
+
+        uint8_t rank(value_type value) const
+        {
+            const auto* chunk = mChunks[value >> chunkBits].get();
+            return chunk ? chunk->ranks[value & (chunkSize - 1)] : 0;
+        }
+
+        void set_rank(value_type value, uint8_t r)
+        {
+            chunk_of(value).ranks[value & (chunkSize - 1)] = r;
+        }
+
+        void compress_path(value_type val, value_type root)
+        {
+            value_type par = parent(val);
+
+            while (par != root)
+            {
+                set_parent(val, root);
+                val = par;
+                par = parent(val);
+            }
+        }
+
+        bool is_root(value_type value) const
+        {
+            return parent(value) == value;
+        }
+
+    private:
+
+        size_type mSize = 0;
+        size_type mAllocatedChunks = 0;
+        std::vector<std::unique_ptr<chunk_type>> mChunks; // nullptr: all elements are singletons
+};
+
+template<unsigned parent_bits>
+constexpr unsigned compact_union_find<parent_bits>::parentBytes;
+
+template<unsigned parent_bits>
+constexpr unsigned compact_union_find<parent_bits>::chunkBits;
+
+template<unsigned parent_bits>
+constexpr typename compact_union_find<parent_bits>::size_type compact_union_find<parent_bits>::chunkSize;
+
+template<unsigned parent_bits>
+constexpr typename compact_union_find<parent_bits>::size_type compact_union_find<parent_bits>::maxSize;
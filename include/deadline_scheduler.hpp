@@ -0,0 +1,269 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define DEADLINE_SCHEDULER_COROUTINES 1
+#endif
+
+#include "indexed_heap.hpp"
+
+/// Single-threaded timers on an indexed_heap: each timer id in [0, timerCount) has at most one
+/// pending deadline, run_until(now) fires the callbacks of all timers due by `now`.
+///
+/// Callbacks are stored by timer id in slots allocated at construction and stay with their id after
+/// firing or cancel(), so re-arming with schedule(id, when) or reschedule() only moves the id in the
+/// heap and never allocates. time_type is an integral tick count, callback_type is called with the
+/// timer id and must be testable for emptiness (std::function, function pointers).
+template<typename id_type, typename time_type, typename callback_type = std::function<void(id_type)>,
+         template<typename...> class container = std::vector>
+class deadline_scheduler
+{
+    public:
+        deadline_scheduler(id_type timerCount = 0)
+            : mTimers(timerCount)
+            , mCallbacks(timerCount)
+            , mDue(timerCount, false)
+        {}
+
+        /// Number of armed timers
+        size_t size() const
+        { return mTimers.size() + mDueCount; }
+
+        bool empty() const
+        { return size() == 0; }
+
+        size_t timer_count() const
+        { return mTimers.element_count(); }
+
+        /// Arms (or re-arms) the timer with a new callback
+        void schedule(const id_type id, const time_type when, callback_type callback)
+        {
+            mCallbacks.at(id) = std::move(callback);
+            schedule(id, when);
+        }
+
+        /// Arms (or re-arms) the timer with the callback it had before
+        void schedule(const id_type id, const time_type when)
+        {
+            if (!mCallbacks.at(id) && !firing(id))
+                throw std::invalid_argument("deadline_scheduler::schedule(): timer has no callback");
+            clear_due(id);
+            mTimers.set_priority(id, when);
+        }
+
+        /// Moves the deadline of an armed timer, false if it is not armed
+        bool reschedule(const id_type id, const time_type when)
+        {
+            if (clear_due(id))
+            {
+                mTimers.push(id, when);
+                return true;
+            }
+            return mTimers.change_priority(id, when);
+        }
+
+        /// Disarms a timer, false if it is not armed. Its callback stays for schedule(id, when).
+        bool cancel(const id_type id)
+        {
+            return clear_due(id) || mTimers.erase(id);
+        }
+
+        bool armed(const id_type id) const
+        { return mDue.at(id) || mTimers.contains(id); }
+
+        /// Deadline of an armed timer
+        time_type deadline(const id_type id) const
+        {
+            if (mDue.at(id))
+                return mDueTimes[due_position(id)].second;
+            return mTimers.get_priority(id);
+        }
+
+        /// Earliest deadline of the armed timers, throws std::out_of_range if there are none
+        time_type next_deadline() const
+        {
+            for (size_t pos = mFired; mDueCount > 0 && pos < mDueTimes.size(); ++pos)
+            {
+                if (!mDue[mDueTimes[pos].first])
+                    continue;
+
+                // a callback may have armed a timer before the rest of the batch
+                const time_type due = mDueTimes[pos].second;
+                return mTimers.empty() || due < mTimers.top_priority() ? due : mTimers.top_priority();
+            }
+            return mTimers.top_priority();
+        }
+
+        /// Fires the timers with deadlines up to `now` in deadline order, returns how many fired.
+        ///
+        /// The due timers are taken from the heap as one batch before the first callback runs.
+        /// Callbacks may schedule, reschedule or cancel any timer: a due timer that is rescheduled or
+        /// cancelled before its turn does not fire, a timer armed for `now` or earlier by a callback
+        /// fires in the next run_until(). If a callback throws, the timers of the batch that have not
+        /// fired stay armed with their deadlines.
+        size_t run_until(const time_type now)
+        {
+            if (mRunning)
+                throw std::logic_error("deadline_scheduler::run_until(): called from a callback");
+
+            mDueTimes.clear();
+            while (!mTimers.empty() && !(now < mTimers.top_priority()))
+            {
+                const id_type id = mTimers.top();
+                mDueTimes.emplace_back(id, mTimers.top_priority());
+                mDue[id] = true;
+                mTimers.pop();
+            }
+            mDueCount = mDueTimes.size();
+
+            size_t fired = 0;
+            mRunning = true;
+            try
+            {
+                for (mFired = 0; mFired < mDueTimes.size(); ++mFired)
+                {
+                    const id_type id = mDueTimes[mFired].first;
+                    if (!clear_due(id))
+                        continue;
+
+                    // moved out while it runs, it may replace itself through schedule()
+                    callback_type callback = std::move(mCallbacks[id]);
+                    mCallbacks[id] = callback_type();
+                    mReleased = false;
+                    restore_callback restore{mCallbacks[id], callback, mReleased};
+                    callback(id);
+                    ++fired;
+                }
+            }
+            catch (...)
+            {
+                // the throwing timer has fired
+                for (++mFired; mFired < mDueTimes.size(); ++mFired)
+                {
+                    const auto& due = mDueTimes[mFired];
+                    if (clear_due(due.first))
+                        mTimers.push(due.first, due.second);
+                }
+                mFired = 0;
+                mRunning = false;
+                throw;
+            }
+
+            mFired = 0;
+            mRunning = false;
+            return fired;
+        }
+
+#ifdef DEADLINE_SCHEDULER_COROUTINES
+        /// `co_await scheduler.sleep_until(id, when)` suspends the coroutine until run_until()
+        /// reaches `when`, using timer `id`. Cancelling the timer leaves the coroutine suspended.
+        /// The timer has no callback after the coroutine resumed, schedule(id, when) without a new
+        /// callback throws instead of resuming a coroutine that may be gone.
+        auto sleep_until(const id_type id, const time_type when)
+        {
+            struct awaiter
+            {
+                deadline_scheduler& scheduler;
+                id_type id;
+                time_type when;
+
+                bool await_ready() const noexcept
+                { return false; }
+
+                void await_suspend(std::coroutine_handle<> handle)
+                {
+                    // a lambda holding a pointer and a handle fits the small buffer of the
+                    // std::function of libstdc++ and libc++, which is not guaranteed by the standard
+                    deadline_scheduler* self = &scheduler;
+                    scheduler.schedule(id, when, [self, handle](id_type fired)
+                    {
+                        self->release_callback(fired);
+                        handle.resume();
+                    });
+                }
+
+                void await_resume() const noexcept
+                {}
+            };
+
+            return awaiter{*this, id, when};
+        }
+#endif
+
+    protected:
+
+        /// Takes a timer out of the current batch, false if it was not waiting in it
+        bool clear_due(const id_type id)
+        {
+            if (!mDue.at(id))
+                return false;
+            mDue[id] = false;
+            --mDueCount;
+            return true;
+        }
+
+        /// Whether the callback of the timer is running
+        bool firing(const id_type id) const
+        { return mRunning && mFired < mDueTimes.size() && mDueTimes[mFired].first == id; }
+
+        /// Drops the callback of a timer, a running one is not put back into its slot
+        void release_callback(const id_type id)
+        {
+            if (firing(id))
+                mReleased = true;
+            else
+                mCallbacks.at(id) = callback_type();
+        }
+
+        /// Puts a running callback back into its slot unless it was replaced or released, also on
+        /// exceptions
+        struct restore_callback
+        {
+            callback_type& slot;
+            callback_type& callback;
+            const bool& released;
+
+            ~restore_callback()
+            {
+                if (!slot && !released)
+                    slot = std::move(callback);
+            }
+        };
+
+        size_t due_position(const id_type id) const
+        {
+            for (size_t pos = mFired; pos < mDueTimes.size(); ++pos)
+            {
+                if (mDueTimes[pos].first == id)
+                    return pos;
+            }
+            throw std::logic_error("deadline_scheduler: due timer not in the batch");
+        }
+
+        /// Exposes contains() on the heap of pending deadlines
+        class timer_heap
+            : public indexed_heap<id_type, time_type, void, container>
+        {
+            public:
+                using indexed_heap<id_type, time_type, void, container>::indexed_heap;
+
+                bool contains(const id_type id) const
+                { return this->mIndex.at(id) != this->invalidIndex; }
+        };
+
+        timer_heap mTimers; // armed timers not in the current batch, by deadline
+        container<callback_type> mCallbacks; // by timer id
+        container<bool> mDue; // by timer id, whether it waits in the current batch
+        std::vector<std::pair<id_type, time_type>> mDueTimes; // current batch, reused between runs
+        size_t mDueCount = 0; // timers of the current batch that have not fired or been disarmed
+        size_t mFired = 0; // position in the current batch
+        bool mRunning = false; // in run_until()
+        bool mReleased = false; // the running callback released itself
+};
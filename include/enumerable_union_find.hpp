@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "union_find.hpp"
+
+/// union_find that can enumerate the members of a set in O(size of the set).
+///
+/// The members of every set form a circular list through an extra "next in set" array, which join
+/// maintains in O(1) by splicing the two lists. This costs one more value per element, so it is a
+/// separate type and plain union_find keeps its footprint.
+template<typename T, template<typename...> class container = std::vector>
+class enumerable_union_find
+    : protected union_find<T, container>
+{
+        using base = union_find<T, container>;
+
+    public:
+
+        using typename base::value_type;
+        using typename base::size_type;
+
+        using base::max_value;
+        using base::size;
+        using base::find;
+        using base::find_opt;
+        using base::find_batch;
+        using base::same_set_batch;
+        using base::count_disjoint;
+        using base::count_singleton;
+
+        enumerable_union_find(value_type n)
+            : base(n)
+        {
+            link_new(0);
+        }
+
+        void resize(size_type n)
+        {
+            base::resize(n);
+            link_new(mNext.size());
+        }
+
+        bool join(value_type v1, value_type v2)
+        {
+            if (!base::join(v1, v2))
+                return false;
+
+            // swapping the successors of one member of each of two circular lists splices them
+            std::swap(mNext[v1], mNext[v2]);
+            return true;
+        }
+
+        /// Calls fn(member) for every member of the set of value, starting with value
+        template<typename Function>
+        void for_each_member(value_type value, Function fn) const
+        {
+            if (static_cast<size_type>(value) >= size())
+                throw std::out_of_range("enumerable_union_find::for_each_member(): value out of range");
+
+            value_type member = value;
+            do
+            {
+                fn(member);
+                member = mNext[member];
+            }
+            while (member != value);
+        }
+
+        std::vector<value_type> members(value_type value) const
+        {
+            std::vector<value_type> result;
+            for_each_member(value, [&result](value_type member) { result.push_back(member); });
+            return result;
+        }
+
+    protected:
+
+        /// Makes the elements from origSize on singleton lists
+        void link_new(size_type origSize)
+        {
+            mNext.resize(size());
+            for (size_type value = origSize; value < size(); ++value)
+                mNext[value] = static_cast<value_type>(value);
+        }
+
+    private:
+
+        container<value_type> mNext; // next member of the same set, circular
+};
@@ -3,17 +3,71 @@
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
-template<typename elem_type, typename prio_type>
+/// Optional per element values of indexed_heap, stored by element so sifting never moves them
+template<typename payload_type, template<typename...> class container>
+class indexed_heap_payload
+{
+    protected:
+        indexed_heap_payload(size_t itemCount)
+            : mValues(itemCount)
+        {}
+
+        void release_value(size_t elem)
+        { mValues[elem] = payload_type(); }
+
+        void resize_values(size_t itemCount)
+        { mValues.resize(itemCount); }
+
+        container<payload_type> mValues; // payload by element
+};
+
+template<template<typename...> class container>
+class indexed_heap_payload<void, container>
+{
+    protected:
+        indexed_heap_payload(size_t)
+        {}
+
+        void release_value(size_t)
+        {}
+
+        void resize_values(size_t)
+        {}
+};
+
+/// Smallest unsigned type that indexes maxItemCount elements, its maximum is reserved as invalid
+template<uint64_t maxItemCount>
+using indexed_heap_index_t =
+    std::conditional_t<maxItemCount < 0xffu, uint8_t,
+    std::conditional_t<maxItemCount < 0xffffu, uint16_t,
+    std::conditional_t<maxItemCount < 0xffffffffu, uint32_t, uint64_t>>>;
+
+/// Min-heap of elements in [0, itemCount) by priority, where the priority of queued elements can be
+/// changed. With a non-void payload_type every element also has a value slot (payload_type must be
+/// default constructible, it may be move-only). The heap and the index are kept in `container`,
+/// e.g. segmented_vector instead of std::vector makes growth free of whole content reallocations.
+///
+/// index_type is the type of the heap positions in the index and of the elements stored in the
+/// heap, it limits the element count to its maximum. A narrower type than elem_type, e.g. 32-bit
+/// for uint64_t elements that never exceed 2^32 - 1, shrinks both arrays.
+template<typename elem_type, typename prio_type, typename payload_type = void,
+         template<typename...> class container = std::vector,
+         typename index_t = std::make_unsigned_t<elem_type>>
 class indexed_heap
+    : protected indexed_heap_payload<payload_type, container>
 {
     public:
         static_assert(std::is_integral<elem_type>::value, "indexed_heap: elem_type must be integral");
         static_assert(std::is_unsigned<elem_type>::value, "indexed_heap: elem_type must be unsigned");
         static_assert(std::is_integral<prio_type>::value, "indexed_heap: prio_type must be integral");
-        using index_type = std::make_unsigned_t<elem_type>;
+        static_assert(std::is_integral<index_t>::value && std::is_unsigned<index_t>::value,
+                "indexed_heap: index_type must be an unsigned integral type");
+        using index_type = index_t;
 
     protected:
         const index_type invalidIndex = std::numeric_limits<index_type>::max();
@@ -21,11 +75,11 @@ class indexed_heap
         struct item_type
         {
             prio_type prio;
-            elem_type elem;
+            index_type elem; // elements are less than the element count, which fits index_type
 
             item_type() {}
             item_type(prio_type p, elem_type e)
-                : prio(p), elem(e)
+                : prio(p), elem(static_cast<index_type>(e))
             {}
 
             bool operator< (const item_type& other) const
@@ -37,7 +91,8 @@ class indexed_heap
 
     public:
         indexed_heap(elem_type itemCount = 0)
-            : mIndex(itemCount, invalidIndex)
+            : indexed_heap_payload<payload_type, container>(checked_count(itemCount))
+            , mIndex(itemCount, invalidIndex)
         {
             mHeap.reserve(itemCount);
         }
@@ -45,11 +100,28 @@ class indexed_heap
         auto size() const
         { return mHeap.size(); }
 
+        /// Number of elements that can be pushed, elements are in [0, element_count())
+        size_t element_count() const
+        { return mIndex.size(); }
+
+        /// Grows the element range to [0, itemCount), never shrinks it
+        void reserve_elements(size_t itemCount)
+        {
+            if (itemCount <= element_count())
+                return;
+            if (itemCount - 1 >= invalidIndex)
+                throw std::length_error("indexed_heap::reserve_elements(): itemCount exceeds index_type");
+
+            // the heap itself grows on push, reserving exactly here would reallocate on every call
+            mIndex.resize(itemCount, invalidIndex);
+            this->resize_values(itemCount);
+        }
+
         bool empty() const
         { return mHeap.empty(); }
 
         elem_type top() const
-        { return mHeap.at(0).elem; }
+        { return static_cast<elem_type>(mHeap.at(0).elem); }
 
         prio_type top_priority() const
         { return mHeap.at(0).prio; }
@@ -59,11 +131,12 @@ class indexed_heap
             if (empty())
                 return;
 
-            elem_type e = mHeap.back().elem;
+            const auto e = static_cast<elem_type>(mHeap.back().elem);
             mIndex[e] = 0; // last will be moved to root
             mIndex[mHeap.front().elem] = invalidIndex; // to be removed
+            this->release_value(mHeap.front().elem);
             mHeap.front() = mHeap.back(); // move to root
-            mHeap.resize(mHeap.size() - 1); // remove last moved from
+            mHeap.pop_back(); // remove last moved from
             bubble_down(e, 0); // restore heap property
         }
 
@@ -78,6 +151,41 @@ class indexed_heap
             return true;
         }
 
+        template<typename P = payload_type, typename = std::enable_if_t<!std::is_void<P>::value>>
+        bool push(const elem_type elem, const prio_type priority, P value)
+        {
+            if (!push(elem, priority))
+                return false;
+            this->mValues[elem] = std::move(value);
+            return true;
+        }
+
+        /// Value of a queued element
+        template<typename P = payload_type, typename = std::enable_if_t<!std::is_void<P>::value>>
+        P& value(const elem_type elem)
+        {
+            if (mIndex.at(elem) == invalidIndex)
+                throw std::out_of_range("indexed_heap::value(): element not queued");
+            return this->mValues[elem];
+        }
+
+        template<typename P = payload_type, typename = std::enable_if_t<!std::is_void<P>::value>>
+        const P& value(const elem_type elem) const
+        {
+            if (mIndex.at(elem) == invalidIndex)
+                throw std::out_of_range("indexed_heap::value(): element not queued");
+            return this->mValues[elem];
+        }
+
+        /// Removes the top element and returns its value
+        template<typename P = payload_type, typename = std::enable_if_t<!std::is_void<P>::value>>
+        P pop_with_value()
+        {
+            P value = std::move(this->mValues[top()]);
+            pop();
+            return value;
+        }
+
         prio_type get_priority(const elem_type elem) const
         {
             return mHeap.at(mIndex.at(elem)).prio;
@@ -107,15 +215,48 @@ class indexed_heap
                 push(elem, priority);
         }
 
+        /// Removes a queued element wherever it is in the heap, false if it is not queued
+        bool erase(const elem_type elem)
+        {
+            const auto idx = mIndex.at(elem);
+            if (idx == invalidIndex)
+                return false;
+
+            mIndex[elem] = invalidIndex;
+            this->release_value(elem);
+
+            const auto last = static_cast<elem_type>(mHeap.back().elem);
+            const prio_type old = mHeap[idx].prio;
+            mHeap[idx] = mHeap.back(); // last takes the place of the removed
+            mHeap.pop_back();
+            if (idx == mHeap.size())
+                return true; // removed the last
+
+            mIndex[last] = idx;
+            if (mHeap[idx].prio < old)
+                bubble_up(last, idx);
+            else
+                bubble_down(last, idx);
+            return true;
+        }
+
     protected:
 
+        /// Called before the members are initialized, so not through invalidIndex
+        static size_t checked_count(size_t itemCount)
+        {
+            if (itemCount > 0 && itemCount - 1 >= std::numeric_limits<index_type>::max())
+                throw std::length_error("indexed_heap: itemCount exceeds index_type");
+            return itemCount;
+        }
+
         void bubble_up(elem_type elem, index_type elemIdx)
         {
             index_type parentIdx = (elemIdx - 1) / 2;
 
             while (elemIdx > 0 && mHeap[elemIdx].prio < mHeap[parentIdx].prio)
             {
-                elem_type parent = mHeap[parentIdx].elem;
+                const auto parent = mHeap[parentIdx].elem;
                 std::swap(mHeap[elemIdx], mHeap[parentIdx]);
                 std::swap(mIndex[elem], mIndex[parent]);
 
@@ -126,28 +267,26 @@ class indexed_heap
 
         void bubble_down(elem_type elem, index_type elemIdx)
         {
-            index_type childIdx = 2 * elemIdx + 1; // first child
+            // in size_t, 2 * elemIdx + 1 can exceed index_type
+            size_t childIdx = 2 * static_cast<size_t>(elemIdx) + 1; // first child
 
             while (childIdx < mHeap.size())
             {
-                if (static_cast<size_t>(childIdx) + 1 < mHeap.size() &&
-                        mHeap[childIdx + 1].prio < mHeap[childIdx].prio)
-                {
+                if (childIdx + 1 < mHeap.size() && mHeap[childIdx + 1].prio < mHeap[childIdx].prio)
                     ++childIdx;
-                }
 
                 if (mHeap[elemIdx].prio < mHeap[childIdx].prio)
                     return;
 
-                elem_type child = mHeap[childIdx].elem;
+                const auto child = mHeap[childIdx].elem;
                 std::swap(mHeap[elemIdx], mHeap[childIdx]);
                 std::swap(mIndex[elem], mIndex[child]);
 
-                elemIdx = childIdx;
-                childIdx = 2 * elemIdx + 1;
+                elemIdx = static_cast<index_type>(childIdx);
+                childIdx = 2 * childIdx + 1;
             }
         }
 
-        std::vector<item_type> mHeap; // min-heap of priorized elements
-        std::vector<index_type> mIndex; // index in heap by element
+        container<item_type> mHeap; // min-heap of priorized elements
+        container<index_type> mIndex; // index in heap by element
 };
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "union_find.hpp"
+
+/// union_find that records its joins as a Kruskal reconstruction tree.
+///
+/// The values [0, n) are the leaves of the tree. Every successful join(v1, v2, weight) creates an
+/// internal node n + i (i-th successful join) with the given weight, whose two children are the
+/// tree nodes of the joined sets. With the joins made in nondecreasing weight order, as Kruskal's
+/// algorithm does, the weight of the lowest common ancestor of a and b is the largest edge weight
+/// on the path between them in the minimum spanning forest, the bottleneck of the best path.
+///
+/// lca_batch() and bottleneck_batch() answer batches of pairs offline with Tarjan's algorithm, in
+/// near-linear time of nodes plus queries, itself on a union_find. All nodes are in flat arrays.
+template<typename T, typename W, template<typename...> class container = std::vector>
+class kruskal_tree
+    : protected union_find<T, container>
+{
+        using base = union_find<T, container>;
+
+    public:
+
+        using typename base::value_type;
+        using typename base::size_type;
+        using weight_type = W;
+        using node_type = size_type; // leaves are the values, internal nodes follow
+
+        static constexpr node_type noNode = std::numeric_limits<node_type>::max();
+
+        using base::max_value;
+        using base::size;
+        using base::find;
+        using base::count_disjoint;
+
+        kruskal_tree(value_type n)
+            : base(n)
+            , mTreeParent(checked_node_count(static_cast<size_type>(n)), noNode)
+            , mChildren(2 * internal_capacity(), noNode)
+            , mWeight(internal_capacity())
+            , mTop(static_cast<size_type>(n))
+        {
+            for (size_type value = 0; value < static_cast<size_type>(n); ++value)
+                mTop[value] = value;
+        }
+
+        /// Joins the sets of v1 and v2 through a new internal node of the given weight, which must
+        /// not be less than the weight of the previous join
+        bool join(value_type v1, value_type v2, weight_type weight)
+        {
+            const auto r1 = this->find(v1);
+            const auto r2 = this->find(v2);
+            if (r1 == r2)
+                return false;
+            if (mInternal > 0 && weight < mWeight[mInternal - 1])
+                throw std::invalid_argument("kruskal_tree::join(): weights must be nondecreasing");
+
+            const auto node = static_cast<node_type>(size() + mInternal);
+            mTreeParent[mTop[r1]] = node;
+            mTreeParent[mTop[r2]] = node;
+            mChildren[2 * mInternal] = mTop[r1];
+            mChildren[2 * mInternal + 1] = mTop[r2];
+            mWeight[mInternal] = weight;
+            ++mInternal;
+
+            base::join(r1, r2);
+            mTop[this->find(r1)] = node;
+            return true;
+        }
+
+        /// Leaves plus internal nodes created so far
+        size_t node_count() const
+        { return size() + mInternal; }
+
+        /// Parent of a tree node, noNode for the roots
+        node_type tree_parent(node_type node) const
+        {
+            if (node >= node_count())
+                throw std::out_of_range("kruskal_tree::tree_parent(): node out of range");
+            return mTreeParent[node];
+        }
+
+        /// Weight of an internal node
+        weight_type weight(node_type node) const
+        {
+            if (node < size() || node >= node_count())
+                throw std::out_of_range("kruskal_tree::weight(): not an internal node");
+            return mWeight[node - size()];
+        }
+
+        /// Writes the lowest common ancestor of each pair (->first, ->second) of [first, last) to
+        /// out, noNode for values in different sets
+        template<typename InputIt, typename OutputIt>
+        OutputIt lca_batch(InputIt first, InputIt last, OutputIt out) const
+        {
+            const auto answers = tarjan_lca(first, last);
+            return std::copy(answers.begin(), answers.end(), out);
+        }
+
+        /// Writes the largest weight on the spanning forest path of each pair of [first, last) to
+        /// out, `noPath` for values in different sets and for a value paired with itself
+        template<typename InputIt, typename OutputIt>
+        OutputIt bottleneck_batch(InputIt first, InputIt last, OutputIt out, weight_type noPath) const
+        {
+            for (const auto node : tarjan_lca(first, last))
+            {
+                *out = node == noNode || node < size() ? noPath : mWeight[node - size()];
+                ++out;
+            }
+            return out;
+        }
+
+    protected:
+
+        /// 2n - 1 nodes must fit node_type below noNode
+        static size_type checked_node_count(size_type n)
+        {
+            if (n > std::numeric_limits<size_type>::max() / 2)
+                throw std::length_error("kruskal_tree: 2n - 1 nodes exceed the value type");
+            return n == 0 ? 0 : 2 * n - 1;
+        }
+
+        size_t internal_capacity() const
+        { return size() == 0 ? 0 : size() - 1; }
+
+        /// Offline LCA: a depth first search over the forest, joining every finished subtree into
+        /// its parent in a union_find over the nodes, answers a query when its second endpoint is
+        /// finished with the current ancestor of the set of the first one.
+        template<typename InputIt>
+        std::vector<node_type> tarjan_lca(InputIt first, InputIt last) const
+        {
+            // both endpoints of every query, the answer is already known unless they are two
+            // different values of the same set
+            std::vector<size_type> endpoints;
+            std::vector<node_type> answers;
+            std::vector<bool> pending;
+            std::vector<size_t> offsets(size() + 1, 0);
+            for (; first != last; ++first)
+            {
+                const auto a = static_cast<value_type>(first->first);
+                const auto b = static_cast<value_type>(first->second);
+                pending.push_back(this->find(a) == this->find(b) && a != b);
+
+                endpoints.push_back(static_cast<size_type>(a));
+                endpoints.push_back(static_cast<size_type>(b));
+                answers.push_back(a == b ? static_cast<node_type>(a) : noNode);
+                if (pending.back())
+                {
+                    ++offsets[static_cast<size_type>(a) + 1];
+                    ++offsets[static_cast<size_type>(b) + 1];
+                }
+            }
+
+            // queries by endpoint in compressed sparse row form
+            for (size_t v = 0; v < size(); ++v)
+                offsets[v + 1] += offsets[v];
+            if (offsets[size()] == 0)
+                return answers;
+
+            std::vector<size_t> byEndpoint(offsets[size()]);
+            std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t q = 0; q < answers.size(); ++q)
+            {
+                if (pending[q])
+                {
+                    byEndpoint[fill[endpoints[2 * q]]++] = q;
+                    byEndpoint[fill[endpoints[2 * q + 1]]++] = q;
+                }
+            }
+
+            const size_t nodes = node_count();
+            // the union_find is over the internal nodes only, a finished leaf is always in the set
+            // of its parent
+            union_find<size_type> subtrees(static_cast<size_type>(mInternal));
+            std::vector<node_type> ancestor(mInternal); // by set of internal nodes
+            std::vector<bool> finished(size(), false);
+            std::vector<bool> entered(mInternal, false);
+            std::vector<node_type> stack;
+
+            for (node_type root = size(); root < nodes; ++root)
+            {
+                if (mTreeParent[root] != noNode)
+                    continue;
+
+                // an internal node stays on the stack until both children are finished
+                stack.push_back(root);
+                while (!stack.empty())
+                {
+                    const node_type top = stack.back();
+                    if (top < size())
+                    {
+                        stack.pop_back();
+                        finished[top] = true;
+                        for (size_t e = offsets[top]; e < offsets[top + 1]; ++e)
+                        {
+                            const size_t query = byEndpoint[e];
+                            const size_type other = endpoints[2 * query] == top ? endpoints[2 * query + 1] : endpoints[2 * query];
+                            if (finished[other])
+                                answers[query] = ancestor[subtrees.find(mTreeParent[other] - size())];
+                        }
+                        continue;
+                    }
+
+                    const size_type internal = top - size();
+                    if (!entered[internal])
+                    {
+                        entered[internal] = true;
+                        ancestor[internal] = top;
+                        stack.push_back(mChildren[2 * internal + 1]);
+                        stack.push_back(mChildren[2 * internal]);
+                        continue;
+                    }
+
+                    // finished, joins the set of the parent
+                    stack.pop_back();
+                    const node_type parent = mTreeParent[top];
+                    if (parent != noNode)
+                    {
+                        subtrees.join(parent - size(), internal);
+                        ancestor[subtrees.find(parent - size())] = parent;
+                    }
+                }
+            }
+            return answers;
+        }
+
+    private:
+
+        container<node_type> mTreeParent; // by node
+        container<node_type> mChildren; // two per internal node
+        container<weight_type> mWeight; // by internal node
+        container<node_type> mTop; // tree node of the set, by union_find root
+        size_t mInternal = 0; // internal nodes created
+};
+
+template<typename T, typename W, template<typename...> class container>
+constexpr typename kruskal_tree<T, W, container>::node_type kruskal_tree<T, W, container>::noNode;
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "indexed_heap.hpp"
+
+/// indexed_heap that defers priority updates until the order is needed.
+///
+/// push(), change_priority() and set_priority() only record the new priority in an element indexed
+/// array and the element in a dirty list, O(1) without touching the heap. top(), top_priority() and
+/// pop() first restore the heap order: with few dirty elements each is sifted into place, with many
+/// the whole heap is rebuilt in O(n). Bursts of updates between pops are cheap, an element updated
+/// several times is sifted once.
+template<typename elem_type, typename prio_type, template<typename...> class container = std::vector,
+         typename index_t = std::make_unsigned_t<elem_type>>
+class lazy_indexed_heap
+    : protected indexed_heap<elem_type, prio_type, void, container, index_t>
+{
+        using base = indexed_heap<elem_type, prio_type, void, container, index_t>;
+
+    public:
+        using typename base::index_type;
+
+        lazy_indexed_heap(elem_type itemCount = 0)
+            : base(itemCount)
+            , mPending(itemCount)
+            , mDirty(itemCount, false)
+        {}
+
+        /// Number of queued elements, including pushes not yet in the heap
+        size_t size() const
+        { return this->mHeap.size() + mPendingPushes; }
+
+        bool empty() const
+        { return size() == 0; }
+
+        using base::element_count;
+
+        void reserve_elements(size_t itemCount)
+        {
+            base::reserve_elements(itemCount);
+            mPending.resize(this->element_count());
+            mDirty.resize(this->element_count(), false);
+        }
+
+        /// Number of recorded updates not yet applied to the heap
+        size_t pending_updates() const
+        { return mDirtyElems.size(); }
+
+        elem_type top()
+        {
+            flush();
+            return base::top();
+        }
+
+        prio_type top_priority()
+        {
+            flush();
+            return base::top_priority();
+        }
+
+        void pop()
+        {
+            flush();
+            base::pop();
+        }
+
+        bool push(const elem_type elem, const prio_type priority)
+        {
+            if (queued(elem))
+                return false;
+
+            record(elem, priority);
+            ++mPendingPushes;
+            return true;
+        }
+
+        prio_type get_priority(const elem_type elem) const
+        {
+            if (mDirty.at(elem))
+                return mPending[elem];
+            return base::get_priority(elem);
+        }
+
+        bool change_priority(const elem_type elem, const prio_type priority)
+        {
+            if (!queued(elem))
+                return false;
+
+            record(elem, priority);
+            return true;
+        }
+
+        void set_priority(const elem_type elem, const prio_type priority)
+        {
+            if (!change_priority(elem, priority))
+                push(elem, priority);
+        }
+
+        /// Applies the recorded updates, top() and pop() do this implicitly
+        void flush()
+        {
+            if (mDirtyElems.empty())
+                return;
+
+            if (rebuild_is_cheaper())
+                rebuild();
+            else
+                sift_dirty();
+
+            mDirtyElems.clear();
+            mPendingPushes = 0;
+        }
+
+    protected:
+
+        bool queued(const elem_type elem) const
+        { return mDirty.at(elem) || this->mIndex[elem] != this->invalidIndex; }
+
+        void record(const elem_type elem, const prio_type priority)
+        {
+            mPending[elem] = priority;
+            if (!mDirty[elem])
+            {
+                mDirty[elem] = true;
+                mDirtyElems.push_back(elem);
+            }
+        }
+
+        /// Sifting costs about log2(n) steps per dirty element, a rebuild about 2n
+        bool rebuild_is_cheaper() const
+        {
+            size_t depth = 0;
+            for (size_t n = size(); n > 1; n /= 2)
+                ++depth;
+            return mDirtyElems.size() * depth > 2 * size();
+        }
+
+        void sift_dirty()
+        {
+            for (const auto elem : mDirtyElems)
+            {
+                mDirty[elem] = false;
+                const auto idx = this->mIndex[elem];
+                if (idx == this->invalidIndex)
+                {
+                    base::push(elem, mPending[elem]);
+                    continue;
+                }
+
+                // every other pair of the heap is still ordered, one of the sifts is a no-op
+                const prio_type old = this->mHeap[idx].prio;
+                this->mHeap[idx].prio = mPending[elem];
+                if (mPending[elem] < old)
+                    this->bubble_up(elem, idx);
+                else
+                    this->bubble_down(elem, idx);
+            }
+        }
+
+        /// Floyd's bottom-up heap construction over all elements, O(n)
+        void rebuild()
+        {
+            for (const auto elem : mDirtyElems)
+            {
+                mDirty[elem] = false;
+                auto& idx = this->mIndex[elem];
+                if (idx == this->invalidIndex)
+                {
+                    idx = static_cast<index_type>(this->mHeap.size());
+                    this->mHeap.emplace_back(mPending[elem], elem);
+                }
+                else
+                {
+                    this->mHeap[idx].prio = mPending[elem];
+                }
+            }
+
+            for (size_t idx = this->mHeap.size() / 2; idx-- > 0; )
+                this->bubble_down(this->mHeap[idx].elem, static_cast<index_type>(idx));
+        }
+
+        container<prio_type> mPending; // recorded priority by element, valid while dirty
+        container<bool> mDirty; // by element, whether it is in mDirtyElems
+        std::vector<elem_type> mDirtyElems;
+        size_t mPendingPushes = 0; // dirty elements not in the heap yet
+};
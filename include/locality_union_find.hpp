@@ -0,0 +1,256 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "union_find.hpp"
+
+/// union_find that links roots in the order of a fixed hash of their values instead of comparing
+/// set sizes: randomized linking, which keeps the expected tree depth logarithmic, made
+/// deterministic. join() does not read the sizes of the sets, only the two root values.
+template<typename T, template<typename...> class container = std::vector>
+class hash_linked_union_find
+    : public union_find<T, container>
+{
+        using base = union_find<T, container>;
+
+    public:
+
+        using typename base::value_type;
+        using typename base::size_type;
+
+        using base::base;
+
+        bool join(value_type v1, value_type v2)
+        {
+            auto r1 = this->find(v1);
+            auto r2 = this->find(v2);
+
+            if (r1 == r2)
+                return false;
+
+            if (link_priority(r1) < link_priority(r2))
+                std::swap(r1, r2);
+
+            this->merge_into_left(r1, r2);
+
+            return true;
+        }
+
+        /// union_find::merge() with hash linking
+        void merge(const base& other)
+        {
+            this->merge_with(other, [this](value_type value, value_type root) { join(value, root); });
+        }
+
+        /// union_find::merge_root_map() with hash linking
+        void merge_root_map(const uint8_t* data, size_t length)
+        {
+            this->merge_root_map_with(data, length, [this](value_type value, value_type root) { join(value, root); });
+        }
+
+        void merge_root_map(const std::vector<uint8_t>& rootMap)
+        {
+            merge_root_map(rootMap.data(), rootMap.size());
+        }
+
+        static hash_linked_union_find from_root_map(const uint8_t* data, size_t length)
+        {
+            hash_linked_union_find result(0);
+            result.build_from_root_map(data, length);
+            return result;
+        }
+
+        static hash_linked_union_find from_root_map(const std::vector<uint8_t>& rootMap)
+        {
+            return from_root_map(rootMap.data(), rootMap.size());
+        }
+
+        /// The root with the higher priority becomes the parent (64-bit MurmurHash3 finalizer)
+        static uint64_t link_priority(value_type value)
+        {
+            uint64_t x = static_cast<uint64_t>(value);
+            x ^= x >> 33;
+            x *= 0xff51afd7ed558ccdULL;
+            x ^= x >> 33;
+            x *= 0xc4ceb9fe1a85ec53ULL;
+            x ^= x >> 33;
+            return x;
+        }
+};
+
+/// New value by original value for the values [0, n), so that values connected by the sample
+/// edges [first, last) get adjacent new values.
+///
+/// Elements are numbered in breadth first order over the sample graph, starting each search from
+/// the highest degree element not numbered yet. Elements without sample edges keep their relative
+/// order after all others. `EdgeIt` iterates pairs of values.
+template<typename T, typename EdgeIt>
+std::vector<T> locality_order(std::make_unsigned_t<T> n, EdgeIt first, EdgeIt last)
+{
+    using size_type = std::make_unsigned_t<T>;
+
+    // adjacency lists of the sample graph in compressed sparse row form
+    std::vector<size_t> offsets(static_cast<size_t>(n) + 1, 0);
+    for (auto edge = first; edge != last; ++edge)
+    {
+        const auto from = static_cast<size_type>(edge->first);
+        const auto to = static_cast<size_type>(edge->second);
+        if (from >= n || to >= n)
+            throw std::out_of_range("locality_order(): edge value out of range");
+        ++offsets[from + 1];
+        ++offsets[to + 1];
+    }
+
+    for (size_t v = 0; v < n; ++v)
+        offsets[v + 1] += offsets[v];
+
+    std::vector<size_type> adjacent(offsets[n]);
+    std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+    for (auto edge = first; edge != last; ++edge)
+    {
+        const auto from = static_cast<size_type>(edge->first);
+        const auto to = static_cast<size_type>(edge->second);
+        adjacent[fill[from]++] = to;
+        adjacent[fill[to]++] = from;
+    }
+
+    std::vector<size_type> byDegree;
+    for (size_type v = 0; v < n; ++v)
+    {
+        if (offsets[v + 1] != offsets[v])
+            byDegree.push_back(v);
+    }
+    std::stable_sort(byDegree.begin(), byDegree.end(), [&offsets](size_type a, size_type b)
+            { return offsets[a + 1] - offsets[a] > offsets[b + 1] - offsets[b]; });
+
+    std::vector<T> newValue(n);
+    std::vector<bool> numbered(n, false);
+    std::vector<size_type> queue;
+    queue.reserve(byDegree.size());
+    size_type next = 0;
+
+    for (size_type start : byDegree)
+    {
+        if (numbered[start])
+            continue;
+
+        size_t head = queue.size();
+        queue.push_back(start);
+        numbered[start] = true;
+        newValue[start] = static_cast<T>(next++);
+
+        while (head < queue.size())
+        {
+            const auto v = queue[head++];
+            for (size_t a = offsets[v]; a < offsets[v + 1]; ++a)
+            {
+                const auto u = adjacent[a];
+                if (!numbered[u])
+                {
+                    numbered[u] = true;
+                    newValue[u] = static_cast<T>(next++);
+                    queue.push_back(u);
+                }
+            }
+        }
+    }
+
+    for (size_type v = 0; v < n; ++v)
+    {
+        if (!numbered[v])
+            newValue[v] = static_cast<T>(next++);
+    }
+
+    return newValue;
+}
+
+/// A union-find that stores its elements under permuted values, e.g. from locality_order(), so that
+/// elements likely to share a set are close in memory. The permutation is applied at the interface:
+/// arguments and results are original values.
+template<typename union_find_type>
+class relabeled_union_find
+{
+    public:
+
+        using value_type = typename union_find_type::value_type;
+        using size_type = typename union_find_type::size_type;
+
+        /// newValue[v] is the stored value of v, it must be a permutation of [0, newValue.size())
+        relabeled_union_find(std::vector<value_type> newValue)
+            : mSets(static_cast<value_type>(newValue.size()))
+            , mNewValue(std::move(newValue))
+            , mOrigValue(mNewValue.size(), value_type())
+        {
+            std::vector<bool> seen(mNewValue.size(), false);
+            for (size_t v = 0; v < mNewValue.size(); ++v)
+            {
+                const auto stored = static_cast<size_type>(mNewValue[v]);
+                if (stored >= mNewValue.size() || seen[stored])
+                    throw std::invalid_argument("relabeled_union_find: newValue is not a permutation");
+                seen[stored] = true;
+                mOrigValue[stored] = static_cast<value_type>(v);
+            }
+        }
+
+        value_type max_value() const
+        {
+            return mSets.max_value();
+        }
+
+        size_type size() const
+        {
+            return mSets.size();
+        }
+
+        bool join(value_type v1, value_type v2)
+        {
+            return mSets.join(stored(v1), stored(v2));
+        }
+
+        value_type find(value_type value) const
+        {
+            return mOrigValue[mSets.find(stored(value))];
+        }
+
+        value_type find(value_type value)
+        {
+            return mOrigValue[mSets.find(stored(value))];
+        }
+
+        size_type count_disjoint() const
+        {
+            return mSets.count_disjoint();
+        }
+
+        size_type count_singleton() const
+        {
+            return mSets.count_singleton();
+        }
+
+        /// The permuted union-find, in stored values
+        const union_find_type& stored_sets() const
+        {
+            return mSets;
+        }
+
+    protected:
+
+        value_type stored(value_type value) const
+        {
+            if (static_cast<size_type>(value) >= mNewValue.size())
+                throw std::out_of_range("relabeled_union_find: value out of range");
+            return mNewValue[value];
+        }
+
+    private:
+
+        union_find_type mSets;
+        std::vector<value_type> mNewValue; // stored value by original value
+        std::vector<value_type> mOrigValue; // original value by stored value
+};
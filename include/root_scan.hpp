@@ -0,0 +1,309 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ROOT_SCAN_X86 1
+#endif
+
+/// Kernels that count the roots (`sets[i] == i`) and singletons (roots with `size[i] == 1`) of a
+/// union-find over whole vectors instead of element by element.
+///
+/// On x86 the 32 and 64-bit element types use SSE2, or AVX2 if the CPU supports it (selected at
+/// runtime, no special compiler flags needed), all other types and platforms a branch-free scalar
+/// loop. count_parallel() splits a scan over threads.
+namespace root_scan
+{
+    /// Roots among sets[0, count), where sets[i] belongs to the value first + i
+    template<typename T>
+    size_t count_roots_scalar(const T* sets, size_t first, size_t count)
+    {
+        size_t roots = 0;
+        for (size_t i = 0; i < count; ++i)
+            roots += sets[i] == static_cast<T>(first + i);
+        return roots;
+    }
+
+    template<typename T, typename S>
+    size_t count_singletons_scalar(const T* sets, const S* sizes, size_t first, size_t count)
+    {
+        size_t singletons = 0;
+        for (size_t i = 0; i < count; ++i)
+            singletons += (sets[i] == static_cast<T>(first + i)) & (sizes[i] == 1);
+        return singletons;
+    }
+
+#ifdef ROOT_SCAN_X86
+    namespace detail
+    {
+        // lanes count matches by subtracting the all-ones compare results, 32-bit lanes are summed
+        // up before they can overflow
+        constexpr size_t maxBlock = size_t(1) << 30;
+
+        inline size_t sum_epi32(__m128i acc)
+        {
+            uint32_t lanes[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+            return size_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+        }
+
+        inline size_t sum_epi64(__m128i acc)
+        {
+            uint64_t lanes[2];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+            return lanes[0] + lanes[1];
+        }
+
+        /// 64-bit equality from 32-bit compares, SSE2 has no _mm_cmpeq_epi64
+        inline __m128i cmpeq_epi64_sse2(__m128i a, __m128i b)
+        {
+            const __m128i eq32 = _mm_cmpeq_epi32(a, b);
+            return _mm_and_si128(eq32, _mm_shuffle_epi32(eq32, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+
+        template<bool singletons, typename T, typename S>
+        size_t count_sse2_32(const T* sets, const S* sizes, size_t first, size_t count)
+        {
+            size_t result = 0;
+            size_t i = 0;
+            const __m128i step = _mm_set1_epi32(4);
+            const __m128i one = _mm_set1_epi32(1);
+            __m128i idx = _mm_setr_epi32(static_cast<int>(first), static_cast<int>(first + 1),
+                    static_cast<int>(first + 2), static_cast<int>(first + 3));
+
+            while (count - i >= 4)
+            {
+                const size_t end = i + std::min((count - i) & ~size_t(3), maxBlock);
+                __m128i acc = _mm_setzero_si128();
+                for (; i < end; i += 4)
+                {
+                    __m128i match = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sets + i)), idx);
+                    if (singletons)
+                        match = _mm_and_si128(match, _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sizes + i)), one));
+                    acc = _mm_sub_epi32(acc, match);
+                    idx = _mm_add_epi32(idx, step);
+                }
+                result += sum_epi32(acc);
+            }
+
+            if (singletons)
+                return result + count_singletons_scalar(sets + i, sizes + i, first + i, count - i);
+            return result + count_roots_scalar(sets + i, first + i, count - i);
+        }
+
+        template<bool singletons, typename T, typename S>
+        size_t count_sse2_64(const T* sets, const S* sizes, size_t first, size_t count)
+        {
+            size_t i = 0;
+            const __m128i step = _mm_set1_epi64x(2);
+            const __m128i one = _mm_set1_epi64x(1);
+            __m128i idx = _mm_set_epi64x(static_cast<long long>(first + 1), static_cast<long long>(first));
+            __m128i acc = _mm_setzero_si128();
+
+            for (; i + 2 <= count; i += 2)
+            {
+                __m128i match = cmpeq_epi64_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sets + i)), idx);
+                if (singletons)
+                    match = _mm_and_si128(match, cmpeq_epi64_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sizes + i)), one));
+                acc = _mm_sub_epi64(acc, match);
+                idx = _mm_add_epi64(idx, step);
+            }
+
+            if (singletons)
+                return sum_epi64(acc) + count_singletons_scalar(sets + i, sizes + i, first + i, count - i);
+            return sum_epi64(acc) + count_roots_scalar(sets + i, first + i, count - i);
+        }
+
+        template<bool singletons, typename T, typename S>
+        __attribute__((target("avx2")))
+        size_t count_avx2_32(const T* sets, const S* sizes, size_t first, size_t count)
+        {
+            size_t result = 0;
+            size_t i = 0;
+            const __m256i step = _mm256_set1_epi32(8);
+            const __m256i one = _mm256_set1_epi32(1);
+            __m256i idx = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(first)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+
+            while (count - i >= 8)
+            {
+                const size_t end = i + std::min((count - i) & ~size_t(7), maxBlock);
+                __m256i acc = _mm256_setzero_si256();
+                for (; i < end; i += 8)
+                {
+                    __m256i match = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(sets + i)), idx);
+                    if (singletons)
+                        match = _mm256_and_si256(match, _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(sizes + i)), one));
+                    acc = _mm256_sub_epi32(acc, match);
+                    idx = _mm256_add_epi32(idx, step);
+                }
+                result += sum_epi32(_mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1)));
+            }
+
+            if (singletons)
+                return result + count_singletons_scalar(sets + i, sizes + i, first + i, count - i);
+            return result + count_roots_scalar(sets + i, first + i, count - i);
+        }
+
+        template<bool singletons, typename T, typename S>
+        __attribute__((target("avx2")))
+        size_t count_avx2_64(const T* sets, const S* sizes, size_t first, size_t count)
+        {
+            size_t i = 0;
+            const __m256i step = _mm256_set1_epi64x(4);
+            const __m256i one = _mm256_set1_epi64x(1);
+            __m256i idx = _mm256_add_epi64(_mm256_set1_epi64x(static_cast<long long>(first)), _mm256_setr_epi64x(0, 1, 2, 3));
+            __m256i acc = _mm256_setzero_si256();
+
+            for (; i + 4 <= count; i += 4)
+            {
+                __m256i match = _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(sets + i)), idx);
+                if (singletons)
+                    match = _mm256_and_si256(match, _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(sizes + i)), one));
+                acc = _mm256_sub_epi64(acc, match);
+                idx = _mm256_add_epi64(idx, step);
+            }
+
+            const size_t result = sum_epi64(_mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1)));
+            if (singletons)
+                return result + count_singletons_scalar(sets + i, sizes + i, first + i, count - i);
+            return result + count_roots_scalar(sets + i, first + i, count - i);
+        }
+
+        inline bool has_avx2()
+        {
+            static const bool avx2 = __builtin_cpu_supports("avx2");
+            return avx2;
+        }
+
+        // dispatched on the element size, overloads instead of if constexpr to stay C++14
+        template<bool singletons, typename T, typename S>
+        size_t count_simd(const T* sets, const S* sizes, size_t first, size_t count, std::integral_constant<size_t, 4>)
+        {
+            return has_avx2() ? count_avx2_32<singletons>(sets, sizes, first, count) : count_sse2_32<singletons>(sets, sizes, first, count);
+        }
+
+        template<bool singletons, typename T, typename S>
+        size_t count_simd(const T* sets, const S* sizes, size_t first, size_t count, std::integral_constant<size_t, 8>)
+        {
+            return has_avx2() ? count_avx2_64<singletons>(sets, sizes, first, count) : count_sse2_64<singletons>(sets, sizes, first, count);
+        }
+    }
+#endif
+
+    namespace detail
+    {
+        /// Whether the kernels cover sets of T (and sizes of S)
+        template<typename T, typename S>
+        using vectorized = std::integral_constant<bool,
+#ifdef ROOT_SCAN_X86
+                std::is_integral<T>::value && sizeof(T) == sizeof(S) && (sizeof(T) == 4 || sizeof(T) == 8)
+#else
+                false
+#endif
+                >;
+
+        template<typename T>
+        size_t count_roots(const T* sets, size_t first, size_t count, std::false_type)
+        { return count_roots_scalar(sets, first, count); }
+
+        template<typename T, typename S>
+        size_t count_singletons(const T* sets, const S* sizes, size_t first, size_t count, std::false_type)
+        { return count_singletons_scalar(sets, sizes, first, count); }
+
+#ifdef ROOT_SCAN_X86
+        template<typename T>
+        size_t count_roots(const T* sets, size_t first, size_t count, std::true_type)
+        { return count_simd<false>(sets, sets, first, count, std::integral_constant<size_t, sizeof(T)>()); }
+
+        template<typename T, typename S>
+        size_t count_singletons(const T* sets, const S* sizes, size_t first, size_t count, std::true_type)
+        { return count_simd<true>(sets, sizes, first, count, std::integral_constant<size_t, sizeof(T)>()); }
+#endif
+    }
+
+    template<typename T>
+    size_t count_roots(const T* sets, size_t first, size_t count)
+    {
+        return detail::count_roots(sets, first, count, detail::vectorized<T, T>());
+    }
+
+    template<typename T, typename S>
+    size_t count_singletons(const T* sets, const S* sizes, size_t first, size_t count)
+    {
+        return detail::count_singletons(sets, sizes, first, count, detail::vectorized<T, S>());
+    }
+
+    namespace detail
+    {
+        template<typename...>
+        struct make_void { using type = void; }; // std::void_t is C++17
+    }
+
+    template<typename C, typename = void>
+    struct segment_size : std::integral_constant<size_t, 0> {}; // contiguous
+
+    template<typename C>
+    struct segment_size<C, typename detail::make_void<decltype(C::segmentSize)>::type>
+        : std::integral_constant<size_t, C::segmentSize> {};
+
+    namespace detail
+    {
+        template<typename Function>
+        size_t sum_runs(size_t first, size_t last, Function fn, std::integral_constant<size_t, 0>)
+        {
+            return first < last ? fn(first, last - first) : 0;
+        }
+
+        // only instantiated for segmented containers, segment is never 0 here
+        template<size_t segment, typename Function>
+        size_t sum_runs(size_t first, size_t last, Function fn, std::integral_constant<size_t, segment>)
+        {
+            size_t sum = 0;
+            while (first < last)
+            {
+                const size_t runEnd = std::min(last, (first / segment + 1) * segment);
+                sum += fn(first, runEnd - first);
+                first = runEnd;
+            }
+            return sum;
+        }
+    }
+
+    /// Calls fn(first, count) for the contiguous runs of [first, last) in a container: one run for
+    /// contiguous containers, one per segment for segmented ones (with a static segmentSize)
+    template<typename container_type, typename Function>
+    size_t sum_runs(size_t first, size_t last, Function fn)
+    {
+        return detail::sum_runs(first, last, fn, std::integral_constant<size_t, segment_size<container_type>::value>());
+    }
+
+    /// Sums count(first, last) over [0, n) split into ranges for up to `threads` threads, 0 for
+    /// all hardware threads. Ranges are at least minPerThread long and multiples of 64 elements.
+    template<typename Function>
+    size_t count_parallel(size_t n, unsigned threads, Function count, size_t minPerThread = size_t(1) << 20)
+    {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        const size_t parts = std::max<size_t>(1, std::min<size_t>(threads, n / minPerThread));
+        if (parts == 1)
+            return count(0, n);
+
+        const size_t perPart = (n / parts + 63) & ~size_t(63);
+        std::vector<std::future<size_t>> counting;
+        for (size_t first = perPart; first < n; first += perPart)
+            counting.push_back(std::async(std::launch::async, count, first, std::min(n, first + perPart)));
+
+        size_t sum = count(0, std::min(n, perPart));
+        for (auto& part : counting)
+            sum += part.get();
+        return sum;
+    }
+}
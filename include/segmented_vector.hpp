@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/// A vector-like container of fixed size segments, which grows without moving existing elements.
+///
+/// Growing allocates new segments of `segmentSize` elements, the cost of a resize is proportional
+/// to the number of new elements only, there is no reallocation of the whole content like with
+/// std::vector. Element access is one extra indirection through the segment table. Elements of
+/// allocated segments are default constructed, elements beyond size() keep their last value.
+template<typename T>
+class segmented_vector
+{
+    public:
+        using value_type = T;
+        using size_type = size_t;
+        using reference = T&;
+        using const_reference = const T&;
+
+        static constexpr unsigned segmentBits = 16;
+        static constexpr size_type segmentSize = size_type(1) << segmentBits;
+
+        segmented_vector() = default;
+
+        explicit segmented_vector(size_type n)
+        { resize(n); }
+
+        segmented_vector(size_type n, const T& value)
+        { resize(n, value); }
+
+        size_type size() const
+        { return mSize; }
+
+        bool empty() const
+        { return mSize == 0; }
+
+        size_type capacity() const
+        { return mSegments.size() * segmentSize; }
+
+        reference operator[] (size_type pos)
+        { return mSegments[pos >> segmentBits][pos & (segmentSize - 1)]; }
+
+        const_reference operator[] (size_type pos) const
+        { return mSegments[pos >> segmentBits][pos & (segmentSize - 1)]; }
+
+        reference at(size_type pos)
+        {
+            if (pos >= mSize)
+                throw std::out_of_range("segmented_vector::at(): pos out of range");
+            return (*this)[pos];
+        }
+
+        const_reference at(size_type pos) const
+        {
+            if (pos >= mSize)
+                throw std::out_of_range("segmented_vector::at(): pos out of range");
+            return (*this)[pos];
+        }
+
+        reference front()
+        { return (*this)[0]; }
+
+        const_reference front() const
+        { return (*this)[0]; }
+
+        reference back()
+        { return (*this)[mSize - 1]; }
+
+        const_reference back() const
+        { return (*this)[mSize - 1]; }
+
+        /// Allocates the segments for n elements
+        void reserve(size_type n)
+        {
+            const size_type segments = (n + segmentSize - 1) >> segmentBits;
+            if (segments <= mSegments.size())
+                return;
+
+            mSegments.reserve(std::max(segments, 2 * mSegments.size()));
+            while (mSegments.size() < segments)
+                mSegments.emplace_back(new T[segmentSize]);
+        }
+
+        void resize(size_type n)
+        {
+            reserve(n);
+            for (size_type pos = mSize; pos < n; ++pos)
+                (*this)[pos] = T();
+            mSize = n;
+        }
+
+        void resize(size_type n, const T& value)
+        {
+            reserve(n);
+            for (size_type pos = mSize; pos < n; ++pos)
+                (*this)[pos] = value;
+            mSize = n;
+        }
+
+        void push_back(const T& value)
+        { emplace_back(value); }
+
+        void push_back(T&& value)
+        { emplace_back(std::move(value)); }
+
+        template<typename... Args>
+        reference emplace_back(Args&&... args)
+        {
+            reserve(mSize + 1);
+            auto& slot = (*this)[mSize];
+            slot = T(std::forward<Args>(args)...);
+            ++mSize;
+            return slot;
+        }
+
+        void pop_back()
+        { --mSize; }
+
+    private:
+        size_type mSize = 0;
+        std::vector<std::unique_ptr<T[]>> mSegments;
+};
+
+template<typename T>
+constexpr unsigned segmented_vector<T>::segmentBits;
+
+template<typename T>
+constexpr typename segmented_vector<T>::size_type segmented_vector<T>::segmentSize;
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+/// indexed_heap over at most N elements in std::arrays, for small problems where the allocations of
+/// indexed_heap dominate. Every operation is constexpr (C++17), so queues can be used at compile time.
+template<typename elem_type, typename prio_type, size_t N>
+class static_indexed_heap
+{
+    public:
+        static_assert(std::is_integral<elem_type>::value, "static_indexed_heap: elem_type must be integral");
+        static_assert(std::is_unsigned<elem_type>::value, "static_indexed_heap: elem_type must be unsigned");
+        static_assert(std::is_integral<prio_type>::value, "static_indexed_heap: prio_type must be integral");
+        // positions are below N, the maximum of index_type marks elements that are not queued
+        static_assert(N <= std::numeric_limits<std::make_unsigned_t<elem_type>>::max(),
+                "static_indexed_heap: N must not exceed the maximum of elem_type");
+        using index_type = std::make_unsigned_t<elem_type>;
+
+    protected:
+        static constexpr index_type invalidIndex = std::numeric_limits<index_type>::max();
+
+        struct item_type
+        {
+            prio_type prio {};
+            elem_type elem {};
+        };
+
+    public:
+        constexpr static_indexed_heap(size_t itemCount = N)
+            : mItemCount(itemCount)
+        {
+            if (itemCount > N)
+                throw std::length_error("static_indexed_heap: itemCount exceeds capacity");
+
+            for (auto& idx : mIndex)
+                idx = invalidIndex;
+        }
+
+        constexpr size_t size() const
+        { return mSize; }
+
+        constexpr bool empty() const
+        { return mSize == 0; }
+
+        static constexpr size_t capacity()
+        { return N; }
+
+        constexpr elem_type top() const
+        { return front().elem; }
+
+        constexpr prio_type top_priority() const
+        { return front().prio; }
+
+        constexpr void pop()
+        {
+            if (empty())
+                return;
+
+            const elem_type e = mHeap[mSize - 1].elem;
+            mIndex[e] = 0; // last will be moved to root
+            mIndex[mHeap[0].elem] = invalidIndex; // to be removed
+            mHeap[0] = mHeap[mSize - 1]; // move to root
+            --mSize; // remove last moved from
+            bubble_down(0); // restore heap property
+        }
+
+        constexpr bool push(const elem_type elem, const prio_type priority)
+        {
+            auto& idx = checked_index(elem);
+            if (idx != invalidIndex)
+                return false;
+            idx = static_cast<index_type>(mSize);
+            mHeap[mSize++] = item_type{priority, elem};
+            bubble_up(idx);
+            return true;
+        }
+
+        constexpr prio_type get_priority(const elem_type elem) const
+        {
+            const auto idx = checked_index(elem);
+            if (idx == invalidIndex)
+                throw std::out_of_range("static_indexed_heap::get_priority(): element not queued");
+            return mHeap[idx].prio;
+        }
+
+        constexpr bool change_priority(const elem_type elem, const prio_type priority)
+        {
+            const auto idx = checked_index(elem);
+            if (idx == invalidIndex)
+                return false;
+
+            auto& onHeap = mHeap[idx];
+            if (priority == onHeap.prio)
+                return true;
+
+            const bool decreased = priority < onHeap.prio;
+            onHeap.prio = priority;
+
+            if (decreased)
+                bubble_up(idx);
+            else
+                bubble_down(idx);
+            return true;
+        }
+
+        constexpr void set_priority(const elem_type elem, const prio_type priority)
+        {
+            if (!change_priority(elem, priority))
+                push(elem, priority);
+        }
+
+    protected:
+
+        constexpr const item_type& front() const
+        {
+            if (empty())
+                throw std::out_of_range("static_indexed_heap: empty heap");
+            return mHeap[0];
+        }
+
+        constexpr const index_type& checked_index(const elem_type elem) const
+        {
+            if (elem >= mItemCount)
+                throw std::out_of_range("static_indexed_heap: element out of range");
+            return mIndex[elem];
+        }
+
+        constexpr index_type& checked_index(const elem_type elem)
+        {
+            if (elem >= mItemCount)
+                throw std::out_of_range("static_indexed_heap: element out of range");
+            return mIndex[elem];
+        }
+
+        constexpr void swap_items(index_type idx1, index_type idx2)
+        {
+            const item_type item = mHeap[idx1];
+            mHeap[idx1] = mHeap[idx2];
+            mHeap[idx2] = item;
+
+            mIndex[mHeap[idx1].elem] = idx1;
+            mIndex[mHeap[idx2].elem] = idx2;
+        }
+
+        constexpr void bubble_up(index_type elemIdx)
+        {
+            while (elemIdx > 0)
+            {
+                const index_type parentIdx = (elemIdx - 1) / 2;
+                if (!(mHeap[elemIdx].prio < mHeap[parentIdx].prio))
+                    return;
+
+                swap_items(elemIdx, parentIdx);
+                elemIdx = parentIdx;
+            }
+        }
+
+        constexpr void bubble_down(index_type elemIdx)
+        {
+            size_t childIdx = 2 * static_cast<size_t>(elemIdx) + 1; // first child
+
+            while (childIdx < mSize)
+            {
+                if (childIdx + 1 < mSize && mHeap[childIdx + 1].prio < mHeap[childIdx].prio)
+                    ++childIdx;
+
+                if (mHeap[elemIdx].prio < mHeap[childIdx].prio)
+                    return;
+
+                swap_items(elemIdx, static_cast<index_type>(childIdx));
+                elemIdx = static_cast<index_type>(childIdx);
+                childIdx = 2 * childIdx + 1;
+            }
+        }
+
+        size_t mItemCount;
+        size_t mSize = 0;
+        std::array<item_type, N> mHeap {}; // min-heap of priorized elements
+        std::array<index_type, N> mIndex {}; // index in heap by element
+};
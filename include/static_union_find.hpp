@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+/// union_find over at most N elements in a std::array, for small problems where the allocations of
+/// union_find dominate. Every operation is constexpr (C++17), so sets can be built at compile time.
+template<typename T, size_t N>
+class static_union_find
+{
+    public:
+
+        static_assert(std::is_integral<T>::value, "static_union_find<T, N>: T must be integral");
+        static_assert(N > 0, "static_union_find<T, N>: N must be positive");
+        static_assert(N - 1 <= static_cast<std::make_unsigned_t<T>>(std::numeric_limits<T>::max()),
+                "static_union_find<T, N>: N - 1 must be representable by T");
+
+        using value_type = T;
+        /// Counts up to N, one type wider than T when N is one more than the maximum of T, e.g.
+        /// static_union_find<unsigned char, 256>
+        using size_type = std::conditional_t<(N <= std::numeric_limits<std::make_unsigned_t<T>>::max()),
+                std::make_unsigned_t<T>, std::conditional_t<(N <= 0xffffu), uint16_t,
+                std::conditional_t<(N <= 0xffffffffu), uint32_t, uint64_t>>>;
+
+        constexpr static_union_find(size_t n = N)
+            : mCount(static_cast<size_type>(n))
+        {
+            if (n > N)
+                throw std::length_error("static_union_find: n exceeds capacity");
+
+            for (size_type value = 0; value < mCount; ++value)
+            {
+                mSets[value] = static_cast<value_type>(value);
+                mSize[value] = 1;
+            }
+        }
+
+        constexpr value_type max_value() const
+        {
+            return static_cast<value_type>(mCount - 1);
+        }
+
+        constexpr size_type size() const
+        {
+            return mCount;
+        }
+
+        static constexpr size_type capacity()
+        {
+            return N;
+        }
+
+        constexpr bool join(value_type v1, value_type v2)
+        {
+            auto r1 = find(v1);
+            auto r2 = find(v2);
+
+            if (r1 == r2)
+                return false;
+
+            if (mSize[r1] < mSize[r2])
+            {
+                const auto r = r1;
+                r1 = r2;
+                r2 = r;
+            }
+
+            mSets[r2] = r1;
+            mSize[r1] += mSize[r2];
+
+            return true;
+        }
+
+        constexpr value_type find(value_type value) const
+        {
+            if (static_cast<size_type>(value) >= size())
+                throw std::out_of_range("static_union_find::find(): value out of range");
+
+            value_type root = value;
+            while (mSets[root] != root)
+                root = mSets[root];
+
+            return root;
+        }
+
+        constexpr value_type find_opt(value_type value)
+        {
+            auto root = static_cast<const static_union_find&>(*this).find(value);
+            compress_path(value, root);
+            return root;
+        }
+
+        constexpr value_type find(value_type value)
+        {
+            return find_opt(value);
+        }
+
+        constexpr size_type count_disjoint() const
+        {
+            size_type roots = 0;
+            for (size_type value = 0; value < size(); ++value)
+            {
+                if (mSets[value] == static_cast<value_type>(value))
+                    ++roots;
+            }
+            return roots;
+        }
+
+        constexpr size_type count_singleton() const
+        {
+            size_type singletons = 0;
+            for (size_type value = 0; value < size(); ++value)
+            {
+                if (mSets[value] == static_cast<value_type>(value) && mSize[value] == 1)
+                    ++singletons;
+            }
+            return singletons;
+        }
+
+    protected:
+
+        constexpr void compress_path(value_type val, value_type root)
+        {
+            value_type parent = mSets[val];
+            size_type relinked = 0;
+
+            while (parent != root)
+            {
+                mSets[val] = root;
+                relinked += mSize[val];
+                mSize[parent] -= relinked;
+                val = parent;
+                parent = mSets[val];
+            }
+        }
+
+        constexpr value_type parent(value_type value) const
+        {
+            return mSets[value];
+        }
+
+        constexpr size_type subtree_size(value_type value) const
+        {
+            return mSize[value];
+        }
+
+    private:
+
+        size_type mCount;
+        std::array<value_type, N> mSets {};
+        std::array<size_type, N> mSize {};
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "union_find.hpp"
+
+namespace streaming_components_detail
+{
+    struct file_closer
+    {
+        void operator() (std::FILE* file) const
+        { std::fclose(file); }
+    };
+
+    using file_ptr = std::unique_ptr<std::FILE, file_closer>;
+
+    /// Fills `buffer` with up to buffer.size() / 2 edges, returns the number of edges read.
+    template<typename value_type>
+    size_t read_edges(std::FILE* file, std::vector<value_type>& buffer)
+    {
+        // in bytes, a partial value at the end of the file would be dropped by fread() otherwise
+        const size_t edgeBytes = 2 * sizeof(value_type);
+        const size_t bytes = std::fread(buffer.data(), 1, buffer.size() * sizeof(value_type), file);
+
+        if (std::ferror(file))
+            throw std::runtime_error("stream_components(): error reading edge file");
+        if (bytes % edgeBytes != 0)
+            throw std::runtime_error("stream_components(): truncated edge file");
+
+        return bytes / edgeBytes;
+    }
+
+    /// Connects a chunk of edges in a compact local id space, then joins only the local spanning
+    /// forest into `uf`, in increasing order of the original values.
+    template<typename union_find_type, typename value_type>
+    void join_chunk(union_find_type& uf, const std::vector<value_type>& edges, size_t edgeCount,
+                    std::vector<value_type>& ids)
+    {
+        ids.assign(edges.begin(), edges.begin() + 2 * edgeCount);
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+        auto local_id = [&ids](value_type value)
+        { return static_cast<uint32_t>(std::lower_bound(ids.begin(), ids.end(), value) - ids.begin()); };
+
+        union_find<uint32_t> local(static_cast<uint32_t>(ids.size()));
+        for (size_t e = 0; e < edgeCount; ++e)
+            local.join(local_id(edges[2 * e]), local_id(edges[2 * e + 1]));
+
+        for (uint32_t i = 0; i < ids.size(); ++i)
+        {
+            const auto root = local.find(i);
+            if (root != i)
+                uf.join(ids[i], ids[root]);
+        }
+    }
+}
+
+/// Joins all edges of a binary edge file into `uf`.
+///
+/// The file is a flat sequence of (from, to) pairs of `union_find_type::value_type` in native byte
+/// order. It is read sequentially in chunks of `chunkEdges` edges, the next chunk is read on a
+/// separate thread while the current one is processed. Resident memory beyond `uf` is bounded by
+/// a few buffers of `chunkEdges` edges, independent of the size of the file.
+template<typename union_find_type>
+void stream_components(union_find_type& uf, const std::string& path, size_t chunkEdges = size_t(1) << 22)
+{
+    using value_type = typename union_find_type::value_type;
+    using namespace streaming_components_detail;
+
+    if (chunkEdges == 0 || chunkEdges > std::numeric_limits<uint32_t>::max() / 2)
+        throw std::invalid_argument("stream_components(): chunkEdges out of range");
+
+    file_ptr file(std::fopen(path.c_str(), "rb"));
+    if (!file)
+        throw std::runtime_error("stream_components(): cannot open " + path);
+
+    std::vector<value_type> current(2 * chunkEdges);
+    std::vector<value_type> next(2 * chunkEdges);
+    std::vector<value_type> ids;
+    ids.reserve(2 * chunkEdges);
+
+    size_t edgeCount = read_edges(file.get(), current);
+    while (edgeCount > 0)
+    {
+        auto reading = std::async(std::launch::async,
+                [&file, &next] { return read_edges(file.get(), next); });
+
+        join_chunk(uf, current, edgeCount, ids);
+
+        edgeCount = reading.get();
+        current.swap(next);
+    }
+}
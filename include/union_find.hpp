@@ -1,12 +1,18 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <numeric>
 #include <stdexcept>
 #include <type_traits>
 #include <vector>
 
-template<typename T>
+#include "root_scan.hpp"
+
+/// Disjoint sets of the values [0, n). The parent links and subtree sizes are kept in `container`,
+/// e.g. segmented_vector instead of std::vector lets resize() grow without moving existing data.
+template<typename T, template<typename...> class container = std::vector>
 class union_find
 {
     public:
@@ -16,12 +22,11 @@ class union_find
         using value_type = T;
         using size_type = std::make_unsigned_t<T>;
 
+        static constexpr size_t batchWidth = 32; // root walks interleaved by find_batch()
+
         union_find(value_type n)
-            : mSets(n)
-            , mSize(n)
         {
-            std::iota(mSets.begin(), mSets.end(), 0);
-            std::fill(mSize.begin(), mSize.end(), 1);
+            resize(static_cast<size_type>(n));
         }
 
         value_type max_value() const
@@ -41,11 +46,11 @@ class union_find
             if (n == size())
                 return;
 
-            const auto origSize = mSets.size();
+            const size_type origSize = size();
             mSets.resize(n);
-            mSize.resize(n);
-            std::iota(mSets.begin() + origSize, mSets.end(), origSize);
-            std::fill(mSize.begin() + origSize, mSize.end(), 1);
+            mSize.resize(n, 1);
+            for (size_type value = origSize; value < n; ++value)
+                mSets[value] = static_cast<value_type>(value);
         }
 
         bool join(value_type v1, value_type v2)
@@ -88,30 +93,185 @@ class union_find
             return find_opt(value);
         }
 
-        size_type count_disjoint() const
+        /// Writes the root of each value in [first, last) to out, like a loop of const find().
+        /// The independent root walks of batchWidth values are interleaved and their next steps
+        /// prefetched, so cache misses overlap instead of forming one serial chain per query.
+        template<typename InputIt, typename OutputIt>
+        OutputIt find_batch(InputIt first, InputIt last, OutputIt out) const
         {
-            size_type roots = 0;
-            for (value_type value = 0; value <= max_value(); ++value)
+            value_type nodes[batchWidth];
+
+            while (first != last)
             {
-                if (is_root(value))
-                    ++roots;
+                size_t width = 0;
+                for (; width < batchWidth && first != last; ++width, ++first)
+                    nodes[width] = checked_prefetch(*first, "union_find::find_batch(): value out of range");
+
+                walk_to_roots(nodes, width);
+                out = std::copy(nodes, nodes + width, out);
             }
-            return roots;
+
+            return out;
         }
 
-        size_type count_singleton() const
+        /// Writes whether *firstA and *firstB are in the same set to out for each pair of the two
+        /// ranges, batched the same way as find_batch().
+        template<typename InputIt1, typename InputIt2, typename OutputIt>
+        OutputIt same_set_batch(InputIt1 firstA, InputIt1 lastA, InputIt2 firstB, OutputIt out) const
         {
-            size_type singletons = 0;
-            for (value_type value = 0; value <= max_value(); ++value)
+            value_type nodes[2 * batchWidth];
+
+            while (firstA != lastA)
             {
-                if (is_singleton(value))
-                    ++singletons;
+                size_t width = 0;
+                for (; width < batchWidth && firstA != lastA; ++width, ++firstA, ++firstB)
+                {
+                    nodes[2 * width] = checked_prefetch(*firstA, "union_find::same_set_batch(): value out of range");
+                    nodes[2 * width + 1] = checked_prefetch(*firstB, "union_find::same_set_batch(): value out of range");
+                }
+
+                walk_to_roots(nodes, 2 * width);
+                for (size_t i = 0; i < width; ++i, ++out)
+                    *out = nodes[2 * i] == nodes[2 * i + 1];
             }
-            return singletons;
+
+            return out;
+        }
+
+        /// Joins every value of other to its root there: afterwards two values share a set if they
+        /// did here or in other. Grows to other.size() if that is larger. O(n) joins, the roots of
+        /// the non-root values of other are walked a batch at a time as in find_batch().
+        void merge(const union_find& other)
+        {
+            merge_with(other, [this](value_type value, value_type root) { join(value, root); });
+        }
+
+        /// The partition in the root map exchange format, for merge_root_map() elsewhere:
+        ///
+        ///     varint size, varint count, count * (varint gap, varint root)
+        ///
+        /// with one entry per value that is not a root, in ascending order of values. gap is the
+        /// distance to the previous listed value minus one (the first value itself), varints are
+        /// LEB128, 7 bits per byte. Singletons and roots take no space.
+        std::vector<uint8_t> root_map() const
+        {
+            std::vector<uint8_t> entries;
+            size_t count = 0;
+            size_t next = 0; // value after the last listed one
+            for_each_non_root(*this, [&](value_type value, value_type root)
+            {
+                write_varint(entries, static_cast<size_type>(value) - next);
+                write_varint(entries, static_cast<size_type>(root));
+                next = static_cast<size_type>(value) + 1;
+                ++count;
+            });
+
+            std::vector<uint8_t> result;
+            result.reserve(entries.size() + 20);
+            write_varint(result, size());
+            write_varint(result, count);
+            result.insert(result.end(), entries.begin(), entries.end());
+            return result;
+        }
+
+        /// merge() with a partition in the root map format of root_map(), throws
+        /// std::invalid_argument for malformed data. All entries are checked before it grows or
+        /// joins anything, a corrupted size is only allocated if the rest of the map fits it.
+        void merge_root_map(const uint8_t* data, size_t length)
+        {
+            merge_root_map_with(data, length, [this](value_type value, value_type root) { join(value, root); });
+        }
+
+        void merge_root_map(const std::vector<uint8_t>& rootMap)
+        {
+            merge_root_map(rootMap.data(), rootMap.size());
+        }
+
+        /// The partition of a root map without any finds: every set becomes a root with its other
+        /// values as direct children. Throws std::invalid_argument for malformed data.
+        static union_find from_root_map(const uint8_t* data, size_t length)
+        {
+            union_find result(0);
+            result.build_from_root_map(data, length);
+            return result;
+        }
+
+        static union_find from_root_map(const std::vector<uint8_t>& rootMap)
+        {
+            return from_root_map(rootMap.data(), rootMap.size());
+        }
+
+        /// Number of sets, the roots are counted a vector at a time (root_scan.hpp)
+        size_type count_disjoint() const
+        {
+            return static_cast<size_type>(count_roots(0, size()));
+        }
+
+        /// count_disjoint() split over up to `threads` threads, 0 for all hardware threads
+        size_type count_disjoint(unsigned threads) const
+        {
+            return static_cast<size_type>(root_scan::count_parallel(size(), threads,
+                    [this](size_t first, size_t last) { return count_roots(first, last); }));
+        }
+
+        size_type count_singleton() const
+        {
+            return static_cast<size_type>(count_singletons(0, size()));
+        }
+
+        /// count_singleton() split over up to `threads` threads, 0 for all hardware threads
+        size_type count_singleton(unsigned threads) const
+        {
+            return static_cast<size_type>(root_scan::count_parallel(size(), threads,
+                    [this](size_t first, size_t last) { return count_singletons(first, last); }));
         }
 
     protected:
 
+        /// merge() with the join of a derived class, join(value, root) for every non-root value
+        template<typename Join>
+        void merge_with(const union_find& other, Join join)
+        {
+            if (other.size() > size())
+                resize(other.size());
+
+            for_each_non_root(other, join);
+        }
+
+        /// merge_root_map() with the join of a derived class
+        template<typename Join>
+        void merge_root_map_with(const uint8_t* data, size_t length, Join join)
+        {
+            const uint8_t* const end = data + length;
+            uint64_t count = 0;
+            const size_type n = read_root_map_header(data, end, count);
+            check_root_map_entries(data, end, n, count);
+            if (n > size())
+                resize(n);
+
+            read_root_map_entries(data, end, n, count, join);
+        }
+
+        /// from_root_map() into an empty union_find, also of a derived class: star trees are valid
+        /// under any linking rule
+        void build_from_root_map(const uint8_t* data, size_t length)
+        {
+            const uint8_t* const end = data + length;
+            uint64_t count = 0;
+            const size_type n = read_root_map_header(data, end, count);
+            check_root_map_entries(data, end, n, count);
+            resize(n);
+
+            read_root_map_entries(data, end, n, count, [this](value_type value, value_type root)
+            {
+                // a root must not be listed itself, a listed value must not be used as a root
+                if (root == value || !is_root(root) || mSize[value] != 1)
+                    throw std::invalid_argument("union_find::from_root_map(): not a root map");
+                mSets[value] = root;
+                ++mSize[root];
+            });
+        }
+
         void merge_into_left(value_type r1, value_type r2)
         {
             mSets[r2] = r1;
@@ -133,11 +293,201 @@ class union_find
             }
         }
 
+        void prefetch(value_type value) const
+        {
+#if defined(__GNUC__)
+            __builtin_prefetch(&mSets[value]);
+#else
+            (void) value;
+#endif
+        }
+
+        void prefetch_size(value_type value) const
+        {
+#if defined(__GNUC__)
+            __builtin_prefetch(&mSize[value]);
+#else
+            (void) value;
+#endif
+        }
+
+        value_type checked_prefetch(value_type value, const char* error) const
+        {
+            if (static_cast<size_type>(value) >= size())
+                throw std::out_of_range(error);
+
+            prefetch(value);
+            return value;
+        }
+
+        /// Advances every node one step per round until all of them reach their root
+        void walk_to_roots(value_type* nodes, size_t count) const
+        {
+            bool pending = true;
+            while (pending)
+            {
+                pending = false;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    // branch free: roots step onto themselves, their prefetch is a cache hit
+                    const value_type parent = mSets[nodes[i]];
+                    pending |= parent != nodes[i];
+                    nodes[i] = parent;
+                    prefetch(parent);
+                }
+            }
+        }
+
+        /// Calls fn(value, root) for the values of sets that are not their root, in ascending
+        /// order. Roots are skipped in a sequential scan, the others looked up batchWidth at a time.
+        template<typename Function>
+        static void for_each_non_root(const union_find& sets, Function fn)
+        {
+            value_type values[batchWidth];
+            value_type roots[batchWidth];
+            size_t width = 0;
+
+            const auto flush = [&]
+            {
+                std::copy(values, values + width, roots);
+                sets.walk_to_roots(roots, width);
+                for (size_t i = 0; i < width; ++i)
+                    fn(values[i], roots[i]);
+                width = 0;
+            };
+
+            for (size_t value = 0; value < sets.size(); ++value)
+            {
+                if (sets.is_root(static_cast<value_type>(value)))
+                    continue;
+
+                values[width++] = static_cast<value_type>(value);
+                if (width == batchWidth)
+                    flush();
+            }
+            flush();
+        }
+
+        /// Reads the size and entry count of a root map, leaves data at the first entry
+        static size_type read_root_map_header(const uint8_t*& data, const uint8_t* end, uint64_t& count)
+        {
+            const uint64_t n = read_varint(data, end);
+            count = read_varint(data, end);
+            if (n != static_cast<size_type>(n) || count > n)
+                throw std::invalid_argument("union_find::merge_root_map(): invalid header");
+            return static_cast<size_type>(n);
+        }
+
+        /// Decodes the next entry of a root map of n values, next is the value after the previous entry
+        static void read_root_map_entry(const uint8_t*& data, const uint8_t* end, uint64_t n, uint64_t& next,
+                                        value_type& value, value_type& root)
+        {
+            const uint64_t gap = read_varint(data, end);
+            const uint64_t r = read_varint(data, end);
+            if (gap >= n - next || r >= n)
+                throw std::invalid_argument("union_find::merge_root_map(): value out of range");
+
+            value = static_cast<value_type>(next + gap);
+            root = static_cast<value_type>(r);
+            next += gap + 1;
+        }
+
+        /// Decodes all count entries without using them, throws like read_root_map_entries(). A
+        /// sequential pass over the map, cheap next to the joins.
+        static void check_root_map_entries(const uint8_t* data, const uint8_t* end, uint64_t n, uint64_t count)
+        {
+            uint64_t next = 0;
+            value_type value {};
+            value_type root {};
+            for (uint64_t entry = 0; entry < count; ++entry)
+                read_root_map_entry(data, end, n, next, value, root);
+
+            if (data != end)
+                throw std::invalid_argument("union_find::merge_root_map(): trailing data");
+        }
+
+        /// Calls fn(value, root) for the count entries of a root map of n values. Entries are
+        /// decoded batchWidth at a time and the links and sizes they touch prefetched, the roots are
+        /// random values.
+        template<typename Function>
+        void read_root_map_entries(const uint8_t*& data, const uint8_t* end, uint64_t n, uint64_t count, Function fn)
+        {
+            value_type values[batchWidth];
+            value_type roots[batchWidth];
+            uint64_t next = 0;
+
+            for (uint64_t entry = 0; entry < count; )
+            {
+                const size_t width = static_cast<size_t>(std::min<uint64_t>(batchWidth, count - entry));
+                for (size_t i = 0; i < width; ++i)
+                {
+                    read_root_map_entry(data, end, n, next, values[i], roots[i]);
+                    prefetch(roots[i]);
+                    prefetch_size(roots[i]);
+                }
+
+                // the parents of the values are near each other, their parents are not
+                for (size_t i = 0; i < width; ++i)
+                    prefetch(mSets[values[i]]);
+
+                for (size_t i = 0; i < width; ++i)
+                    fn(values[i], roots[i]);
+                entry += width;
+            }
+
+            if (data != end)
+                throw std::invalid_argument("union_find::merge_root_map(): trailing data");
+        }
+
+        static void write_varint(std::vector<uint8_t>& out, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        static uint64_t read_varint(const uint8_t*& data, const uint8_t* end)
+        {
+            uint64_t value = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7)
+            {
+                if (data == end)
+                    throw std::invalid_argument("union_find::merge_root_map(): truncated data");
+                const uint8_t byte = *data++;
+                value |= uint64_t(byte & 0x7f) << shift;
+                if (!(byte & 0x80))
+                    return value;
+            }
+            throw std::invalid_argument("union_find::merge_root_map(): varint too long");
+        }
+
+        /// Roots among the values [first, last)
+        size_t count_roots(size_t first, size_t last) const
+        {
+            return root_scan::sum_runs<container<value_type>>(first, last, [this](size_t run, size_t count)
+                    { return root_scan::count_roots(&mSets[run], run, count); });
+        }
+
+        /// Singletons among the values [first, last)
+        size_t count_singletons(size_t first, size_t last) const
+        {
+            return root_scan::sum_runs<container<value_type>>(first, last, [this](size_t run, size_t count)
+                    { return root_scan::count_singletons(&mSets[run], &mSize[run], run, count); });
+        }
+
         bool is_root(value_type value) const
         {
             return mSets[value] == value;
         }
 
+        value_type parent(value_type value) const
+        {
+            return mSets[value];
+        }
+
         size_type subtree_size(value_type value) const
         {
             return mSize[value];
@@ -150,6 +500,9 @@ class union_find
 
     private:
 
-        std::vector<value_type> mSets;
-        std::vector<size_type> mSize;
+        container<value_type> mSets;
+        container<size_type> mSize;
 };
+
+template<typename T, template<typename...> class container>
+constexpr size_t union_find<T, container>::batchWidth;
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// union_find where every element also has a potential, known relative to the other elements of
+/// its set. `join(v1, v2, delta)` records potential(v2) - potential(v1) == delta, `diff(v1, v2)`
+/// returns it for any two elements of the same set. Potentials are stored relative to the parent
+/// next to the parent links and are kept consistent by path compression and union by size.
+///
+/// For floating point W, potentials are sums of rounded differences, so a redundant join() is
+/// consistent if it is within `tolerance` of the known difference, relative to the magnitude of the
+/// potentials involved (at least 1). Integral W is compared exactly.
+template<typename T, typename W>
+class weighted_union_find
+{
+    public:
+
+        static_assert(std::is_integral<T>::value, "weighted_union_find<T, W>: T must be integral");
+        static_assert(std::is_arithmetic<W>::value, "weighted_union_find<T, W>: W must be arithmetic");
+
+        using value_type = T;
+        using size_type = std::make_unsigned_t<T>;
+        using weight_type = W;
+
+        enum class join_result
+        {
+            joined,     // the sets were merged
+            consistent, // already in the same set with the same difference
+            conflict    // already in the same set with a different difference
+        };
+
+        /// Default tolerance for floating point W: 2^10 ulps relative, about 2e-13 for double
+        static constexpr weight_type default_tolerance()
+        {
+            return std::is_floating_point<W>::value ? std::numeric_limits<W>::epsilon() * 1024 : weight_type();
+        }
+
+        weighted_union_find(value_type n, weight_type tolerance = default_tolerance())
+            : mSets(n)
+            , mSize(n, 1)
+            , mDiff(n, weight_type())
+            , mTolerance(tolerance)
+        {
+            std::iota(mSets.begin(), mSets.end(), 0);
+        }
+
+        value_type max_value() const
+        {
+            return static_cast<value_type>(mSets.size() - 1);
+        }
+
+        size_type size() const
+        {
+            return mSets.size();
+        }
+
+        join_result join(value_type v1, value_type v2, weight_type delta)
+        {
+            auto r1 = find_opt(v1);
+            auto r2 = find_opt(v2);
+
+            // potentials relative to the roots, the roots are the parents after compression
+            const weight_type p1 = mDiff[v1];
+            const weight_type p2 = mDiff[v2];
+
+            if (r1 == r2)
+                return same_difference(p1, p2, delta) ? join_result::consistent : join_result::conflict;
+
+            // potential(r2) - potential(r1)
+            weight_type rootDelta = delta + p1 - p2;
+
+            if (mSize[r1] < mSize[r2])
+            {
+                std::swap(r1, r2);
+                rootDelta = -rootDelta;
+            }
+
+            mSets[r2] = r1;
+            mSize[r1] += mSize[r2];
+            mDiff[r2] = rootDelta;
+
+            return join_result::joined;
+        }
+
+        value_type find(value_type value) const
+        {
+            return find_with_potential(value).first;
+        }
+
+        value_type find_opt(value_type value)
+        {
+            const auto rootAndPotential = static_cast<const weighted_union_find&>(*this).find_with_potential(value);
+            compress_path(value, rootAndPotential.first, rootAndPotential.second);
+            return rootAndPotential.first;
+        }
+
+        value_type find(value_type value)
+        {
+            return find_opt(value);
+        }
+
+        bool same_set(value_type v1, value_type v2)
+        {
+            return find_opt(v1) == find_opt(v2);
+        }
+
+        /// potential(v2) - potential(v1), the values must be in the same set
+        weight_type diff(value_type v1, value_type v2)
+        {
+            if (find_opt(v1) != find_opt(v2))
+                throw std::invalid_argument("weighted_union_find::diff(): values are in different sets");
+
+            return mDiff[v2] - mDiff[v1];
+        }
+
+        weight_type diff(value_type v1, value_type v2) const
+        {
+            const auto rp1 = find_with_potential(v1);
+            const auto rp2 = find_with_potential(v2);
+            if (rp1.first != rp2.first)
+                throw std::invalid_argument("weighted_union_find::diff(): values are in different sets");
+
+            return rp2.second - rp1.second;
+        }
+
+        size_type count_disjoint() const
+        {
+            size_type roots = 0;
+            for (size_type value = 0; value < size(); ++value)
+            {
+                if (is_root(static_cast<value_type>(value)))
+                    ++roots;
+            }
+            return roots;
+        }
+
+    protected:
+
+        /// Root of value and potential(value) - potential(root)
+        std::pair<value_type, weight_type> find_with_potential(value_type value) const
+        {
+            if (static_cast<size_type>(value) >= size())
+                throw std::out_of_range("weighted_union_find::find(): value out of range");
+
+            value_type root = value;
+            weight_type potential = weight_type();
+            while (!is_root(root))
+            {
+                potential += mDiff[root];
+                root = mSets[root];
+            }
+
+            return {root, potential};
+        }
+
+        void compress_path(value_type val, value_type root, weight_type potential)
+        {
+            value_type parent = mSets[val];
+            size_type relinked = 0;
+
+            while (parent != root)
+            {
+                const weight_type toParent = mDiff[val];
+                mSets[val] = root;
+                mDiff[val] = potential;
+                relinked += mSize[val];
+                mSize[parent] -= relinked;
+                potential -= toParent;
+                val = parent;
+                parent = mSets[val];
+            }
+        }
+
+        /// Whether p2 - p1 is delta, within the tolerance for floating point W
+        bool same_difference(weight_type p1, weight_type p2, weight_type delta) const
+        {
+            if constexpr (std::is_floating_point<W>::value)
+            {
+                const weight_type scale = std::max({weight_type(1), std::abs(p1), std::abs(p2), std::abs(delta)});
+                return std::abs(p2 - p1 - delta) <= mTolerance * scale;
+            }
+            else
+            {
+                return p2 - p1 == delta;
+            }
+        }
+
+        bool is_root(value_type value) const
+        {
+            return mSets[value] == value;
+        }
+
+        value_type parent(value_type value) const
+        {
+            return mSets[value];
+        }
+
+        size_type subtree_size(value_type value) const
+        {
+            return mSize[value];
+        }
+
+    private:
+
+        std::vector<value_type> mSets;
+        std::vector<size_type> mSize;
+        std::vector<weight_type> mDiff; // potential(value) - potential(parent)
+        weight_type mTolerance; // relative, floating point W only
+};
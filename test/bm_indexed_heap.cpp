@@ -1,6 +1,17 @@
-#include <benchmark/benchmark_api.h>
+#include <benchmark/benchmark.h>
+#include <bucket_queue.hpp>
+#include <deadline_scheduler.hpp>
 #include <indexed_heap.hpp>
+#include <lazy_indexed_heap.hpp>
+#include <segmented_vector.hpp>
+#include <static_indexed_heap.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <random>
+#include <string>
+#include <vector>
+#include "perf_counters.hpp"
 
 // =================================================================================================
 void bm_indexed_heap(benchmark::State& state)
@@ -12,6 +23,7 @@ void bm_indexed_heap(benchmark::State& state)
     std::mt19937 gen(rd());
     std::uniform_int_distribution<unsigned> dist(0, nelems-1);
 
+    perf_scope perf(state, 1000000);
     while (state.KeepRunning())
     {
         for (size_t i = 0; i < 1000000; ++i)
@@ -24,7 +36,249 @@ void bm_indexed_heap(benchmark::State& state)
     }
 }
 
+// =================================================================================================
+/// The set_priority loop of bm_indexed_heap with one bucket per possible priority
+void bm_bucket_queue(benchmark::State& state)
+{
+    const unsigned nelems = state.range(0);
+    bucket_queue<unsigned, unsigned> q(nelems, nelems);
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<unsigned> dist(0, nelems-1);
+
+    perf_scope perf(state, 1000000);
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < 1000000; ++i)
+        {
+            unsigned elem = dist(gen);
+            unsigned prio = dist(gen);
+
+            q.set_priority(elem, prio);
+        }
+    }
+}
+
+// =================================================================================================
+/// A small problem per iteration: construct, push nelems random priorities, pop all
+template<typename heap_type>
+void run_small_heap(benchmark::State& state, unsigned nelems)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<unsigned> dist(0, 1000);
+    std::vector<unsigned> prios(nelems);
+    for (auto& prio : prios)
+        prio = dist(gen);
+
+    perf_scope perf(state, nelems);
+    while (state.KeepRunning())
+    {
+        heap_type q(nelems);
+        for (unsigned elem = 0; elem < nelems; ++elem)
+            q.push(elem, prios[elem]);
+        while (!q.empty())
+        {
+            benchmark::DoNotOptimize(q.top());
+            q.pop();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * nelems);
+}
+
+void bm_indexed_heap_small(benchmark::State& state)
+{
+    run_small_heap<indexed_heap<unsigned, unsigned>>(state, state.range(0));
+}
+
+template<size_t N>
+void bm_static_indexed_heap_small(benchmark::State& state)
+{
+    run_small_heap<static_indexed_heap<unsigned, unsigned, N>>(state, N);
+}
+
+// =================================================================================================
+/// Steady growth from 1Ki to nelems elements by 64Ki at a time, pushing every 16th new element and
+/// repriorizing as many random ones. The label shows the longest single reserve_elements().
+template<template<typename...> class container>
+void bm_indexed_heap_growth(benchmark::State& state)
+{
+    const unsigned nelems = state.range(0);
+    const unsigned step = 1 << 16;
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::chrono::steady_clock::duration maxReserve {};
+
+    perf_scope perf(state, nelems);
+    while (state.KeepRunning())
+    {
+        indexed_heap<unsigned, unsigned, void, container> q(1024);
+        while (q.element_count() < nelems)
+        {
+            const unsigned first = q.element_count();
+            const auto start = std::chrono::steady_clock::now();
+            q.reserve_elements(std::min(first + step, nelems));
+            maxReserve = std::max(maxReserve, std::chrono::steady_clock::now() - start);
+
+            std::uniform_int_distribution<unsigned> dist(0, q.element_count() - 1);
+            for (unsigned elem = first; elem < q.element_count(); elem += 16)
+            {
+                q.push(elem, dist(gen));
+                q.change_priority(dist(gen), dist(gen));
+            }
+        }
+    }
+
+    state.SetLabel("max reserve " + std::to_string(
+                std::chrono::duration_cast<std::chrono::microseconds>(maxReserve).count()) + " us");
+}
+
+// =================================================================================================
+/// The set_priority loop of bm_indexed_heap with a pop after every range(1) updates, the updated
+/// elements are drawn from the first range(2) elements (a hot set, updated repeatedly between pops)
+template<typename heap_type>
+void bm_indexed_heap_update_pop(benchmark::State& state)
+{
+    const unsigned nelems = state.range(0);
+    const unsigned updatesPerPop = state.range(1);
+    const unsigned hotElems = state.range(2);
+    heap_type q(nelems);
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<unsigned> dist(0, nelems-1);
+    std::uniform_int_distribution<unsigned> hot(0, hotElems-1);
+
+    // fill the heap, the pops take the minimum of the cold elements too
+    for (unsigned elem = 0; elem < nelems; ++elem)
+        q.push(elem, dist(gen));
+
+    perf_scope perf(state, 1000000);
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < 1000000; ++i)
+        {
+            unsigned elem = hot(gen);
+            unsigned prio = dist(gen);
+
+            q.set_priority(elem, prio);
+            if (i % updatesPerPop == 0)
+                q.pop();
+        }
+    }
+}
+
+// =================================================================================================
+/// Exposes the per element storage of a heap: one item in the heap and one position in the index
+template<typename heap_type>
+struct heap_footprint
+    : heap_type
+{
+    static constexpr size_t bytesPerElem = sizeof(typename heap_type::item_type) + sizeof(typename heap_type::index_type);
+};
+
+/// Random set_priority on a full heap of range(0) 64-bit elements, the label shows the memory of the
+/// heap and the index
+template<typename heap_type>
+void bm_indexed_heap_footprint(benchmark::State& state)
+{
+    const uint64_t nelems = state.range(0);
+    heap_type q(nelems);
+
+    std::random_device rd;
+    std::mt19937_64 gen(rd());
+    std::uniform_int_distribution<uint64_t> dist(0, nelems-1);
+
+    for (uint64_t elem = 0; elem < nelems; ++elem)
+        q.push(elem, static_cast<uint32_t>(dist(gen)));
+
+    perf_scope perf(state, 1000000);
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < 1000000; ++i)
+        {
+            uint64_t elem = dist(gen);
+            uint32_t prio = static_cast<uint32_t>(dist(gen));
+
+            q.set_priority(elem, prio);
+        }
+    }
+
+    state.SetLabel(std::to_string(heap_footprint<heap_type>::bytesPerElem * nelems >> 20) + " MiB");
+}
+
+// =================================================================================================
+/// Per-connection idle timeouts: range(0) armed timers, each re-arm moves a random timer to now plus
+/// a timeout, time advances one tick per range(1) re-arms and fires the timers that ran out (their
+/// callback re-arms them). The timeout is 4 to 8 mean re-arm intervals, few timers expire.
+void bm_deadline_scheduler_rearm(benchmark::State& state)
+{
+    const unsigned ntimers = state.range(0);
+    const unsigned rearmsPerTick = state.range(1);
+    deadline_scheduler<unsigned, uint64_t> scheduler(ntimers);
+    uint64_t now = 0;
+    size_t fired = 0;
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<unsigned> ids(0, ntimers-1);
+    const uint64_t interval = std::max(1u, ntimers / rearmsPerTick);
+    std::uniform_int_distribution<uint64_t> timeouts(4 * interval, 8 * interval);
+
+    for (unsigned id = 0; id < ntimers; ++id)
+    {
+        scheduler.schedule(id, timeouts(gen), [&](unsigned expired)
+        {
+            ++fired;
+            scheduler.schedule(expired, now + 4 * interval);
+        });
+    }
+
+    perf_scope perf(state, 1000000);
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < 1000000; ++i)
+        {
+            scheduler.reschedule(ids(gen), now + timeouts(gen));
+            if (i % rearmsPerTick == 0)
+                scheduler.run_until(++now);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * 1000000);
+    state.SetLabel(std::to_string(fired) + " fired");
+}
+
 // =================================================================================================
 BENCHMARK(bm_indexed_heap)->Arg(100)->Arg(1000)->Arg(10000)->Arg(100000)->Arg(1000000);
 
-BENCHMARK_MAIN()
+BENCHMARK(bm_bucket_queue)->Arg(100)->Arg(1000)->Arg(10000)->Arg(100000)->Arg(1000000);
+
+BENCHMARK(bm_indexed_heap_small)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(bm_static_indexed_heap_small, 16);
+BENCHMARK_TEMPLATE(bm_static_indexed_heap_small, 64);
+BENCHMARK_TEMPLATE(bm_static_indexed_heap_small, 256);
+
+BENCHMARK_TEMPLATE(bm_indexed_heap_growth, std::vector)->Arg(1 << 20)->Arg(1 << 24)->Arg(1 << 27)->Arg(1 << 30)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(bm_indexed_heap_growth, segmented_vector)->Arg(1 << 20)->Arg(1 << 24)->Arg(1 << 27)->Arg(1 << 30)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(bm_indexed_heap_update_pop, indexed_heap<unsigned, unsigned>)
+    ->Args({1000000, 1, 1000000})->Args({1000000, 50, 1000000})->Args({1000000, 1000, 1000000})
+    ->Args({1000000, 50, 10000})->Args({1000000, 1000, 10000})->Args({1000000, 1000, 100});
+BENCHMARK_TEMPLATE(bm_indexed_heap_update_pop, lazy_indexed_heap<unsigned, unsigned>)
+    ->Args({1000000, 1, 1000000})->Args({1000000, 50, 1000000})->Args({1000000, 1000, 1000000})
+    ->Args({1000000, 50, 10000})->Args({1000000, 1000, 10000})->Args({1000000, 1000, 100});
+
+BENCHMARK(bm_deadline_scheduler_rearm)->Args({10000, 100})->Args({100000, 100})->Args({1000000, 100})
+    ->Args({1000000, 10000})->Args({10000000, 10000});
+
+BENCHMARK_TEMPLATE(bm_indexed_heap_footprint, indexed_heap<uint64_t, uint32_t>)
+    ->Arg(1000000)->Arg(100000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(bm_indexed_heap_footprint, indexed_heap<uint64_t, uint32_t, void, std::vector, uint32_t>)
+    ->Arg(1000000)->Arg(100000000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -1,6 +1,22 @@
-#include <benchmark/benchmark_api.h>
+#include <benchmark/benchmark.h>
+#include <compact_union_find.hpp>
+#include <enumerable_union_find.hpp>
+#include <kruskal_tree.hpp>
+#include <locality_union_find.hpp>
+#include <segmented_vector.hpp>
+#include <static_union_find.hpp>
 #include <union_find.hpp>
+#include <weighted_union_find.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
 #include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "perf_counters.hpp"
 
 // =================================================================================================
 void bm_union_find(benchmark::State& state)
@@ -12,14 +28,615 @@ void bm_union_find(benchmark::State& state)
     std::mt19937 gen(rd());
     std::uniform_int_distribution<unsigned> dist(0, nsets-1);
 
+    perf_scope perf(state, 1000000);
     while (state.KeepRunning()) {
         for (size_t i = 0; i < 1000000; ++i)
             uf.join(dist(gen), dist(gen));
     }
 }
 
+// =================================================================================================
+/// The join loop of bm_union_find, with an offset per join
+void bm_weighted_union_find(benchmark::State& state)
+{
+    const unsigned nsets = state.range(0);
+    weighted_union_find<unsigned, long> uf(nsets);
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<unsigned> dist(0, nsets-1);
+
+    perf_scope perf(state, 1000000);
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < 1000000; ++i)
+            uf.join(dist(gen), dist(gen), dist(gen));
+    }
+}
+
+// =================================================================================================
+/// The join loop of bm_union_find, maintaining the member lists
+void bm_enumerable_union_find(benchmark::State& state)
+{
+    const unsigned nsets = state.range(0);
+    enumerable_union_find<unsigned> uf(nsets);
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<unsigned> dist(0, nsets-1);
+
+    perf_scope perf(state, 1000000);
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < 1000000; ++i)
+            uf.join(dist(gen), dist(gen));
+    }
+}
+
+// =================================================================================================
+/// Members of 10 random sets after nelems/8 random joins (mostly small sets)
+template<typename union_find_type, typename members_function>
+void run_members(benchmark::State& state, members_function members)
+{
+    const unsigned nelems = state.range(0);
+    union_find_type uf(nelems);
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<unsigned> dist(0, nelems-1);
+    for (unsigned i = 0; i < nelems / 8; ++i)
+        uf.join(dist(gen), dist(gen));
+
+    std::vector<unsigned> result;
+    perf_scope perf(state, 10);
+    while (state.KeepRunning())
+    {
+        for (unsigned i = 0; i < 10; ++i)
+        {
+            result.clear();
+            members(uf, dist(gen), result);
+            benchmark::DoNotOptimize(result.data());
+        }
+    }
+}
+
+void bm_union_find_members_scan(benchmark::State& state)
+{
+    run_members<union_find<unsigned>>(state, [](union_find<unsigned>& uf, unsigned value, std::vector<unsigned>& result)
+    {
+        const auto root = uf.find(value);
+        for (unsigned v = 0; v <= uf.max_value(); ++v)
+        {
+            if (uf.find(v) == root)
+                result.push_back(v);
+        }
+    });
+}
+
+void bm_enumerable_union_find_members(benchmark::State& state)
+{
+    run_members<enumerable_union_find<unsigned>>(state, [](enumerable_union_find<unsigned>& uf, unsigned value, std::vector<unsigned>& result)
+    {
+        uf.for_each_member(value, [&result](unsigned member) { result.push_back(member); });
+    });
+}
+
+// =================================================================================================
+template<typename T>
+size_t memory_usage(const union_find<T>& uf)
+{
+    return sizeof(uf) + uf.size() * (sizeof(T) + sizeof(typename union_find<T>::size_type));
+}
+
+template<unsigned parent_bits>
+size_t memory_usage(const compact_union_find<parent_bits>& uf)
+{
+    return uf.memory_usage();
+}
+
+// =================================================================================================
+/// find() on a mostly singleton set: the joins stay in every 16th block of 64Ki elements (the
+/// chunks of compact_union_find), nelems/16 random joins within them. Finds are over all elements.
+template<typename union_find_type>
+void bm_union_find_sparse_find(benchmark::State& state)
+{
+    const uint64_t nelems = state.range(0);
+    const uint64_t blockSize = uint64_t(1) << 16;
+    const uint64_t activeBlocks = (nelems / blockSize + 15) / 16;
+    union_find_type uf(nelems);
+
+    std::random_device rd;
+    std::mt19937_64 gen(rd());
+    std::uniform_int_distribution<uint64_t> dist(0, nelems-1);
+    std::uniform_int_distribution<uint64_t> blockDist(0, activeBlocks - 1);
+    std::uniform_int_distribution<uint64_t> offsetDist(0, blockSize - 1);
+    auto active = [&]() { return std::min(nelems - 1, 16 * blockSize * blockDist(gen) + offsetDist(gen)); };
+
+    for (uint64_t i = 0; i < nelems / 16; ++i)
+        uf.join(active(), active());
+
+    perf_scope perf(state, 1000000);
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < 1000000; ++i)
+            benchmark::DoNotOptimize(uf.find(dist(gen)));
+    }
+
+    state.SetLabel(std::to_string(memory_usage(uf) / (1024 * 1024)) + " MiB");
+}
+
+// =================================================================================================
+/// 1M random root queries on a set with nelems/2 random joins, results written to an array
+void setup_queries(union_find<unsigned>& uf, std::vector<unsigned>& queries)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<unsigned> dist(0, uf.max_value());
+
+    for (unsigned i = 0; i < uf.size() / 2; ++i)
+        uf.join(dist(gen), dist(gen));
+
+    queries.resize(1000000);
+    for (auto& query : queries)
+        query = dist(gen);
+}
+
+void bm_union_find_find_loop(benchmark::State& state)
+{
+    union_find<unsigned> uf(state.range(0));
+    std::vector<unsigned> queries, roots(1000000);
+    setup_queries(uf, queries);
+
+    const auto& cuf = uf;
+    perf_scope perf(state, queries.size());
+    while (state.KeepRunning())
+    {
+        for (size_t i = 0; i < queries.size(); ++i)
+            roots[i] = cuf.find(queries[i]);
+        benchmark::DoNotOptimize(roots.data());
+    }
+    state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+void bm_union_find_find_batch(benchmark::State& state)
+{
+    union_find<unsigned> uf(state.range(0));
+    std::vector<unsigned> queries, roots(1000000);
+    setup_queries(uf, queries);
+
+    perf_scope perf(state, queries.size());
+    while (state.KeepRunning())
+    {
+        uf.find_batch(queries.begin(), queries.end(), roots.begin());
+        benchmark::DoNotOptimize(roots.data());
+    }
+    state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+// =================================================================================================
+/// A small problem per iteration: construct, nelems random joins, count the sets
+template<typename union_find_type>
+void run_small_union_find(benchmark::State& state, unsigned nelems)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<unsigned> dist(0, nelems-1);
+    std::vector<unsigned> joins(2 * nelems);
+    for (auto& value : joins)
+        value = dist(gen);
+
+    perf_scope perf(state, nelems);
+    while (state.KeepRunning())
+    {
+        union_find_type uf(nelems);
+        for (unsigned i = 0; i < nelems; ++i)
+            uf.join(joins[2 * i], joins[2 * i + 1]);
+        benchmark::DoNotOptimize(uf.count_disjoint());
+    }
+    state.SetItemsProcessed(state.iterations() * nelems);
+}
+
+void bm_union_find_small(benchmark::State& state)
+{
+    run_small_union_find<union_find<unsigned>>(state, state.range(0));
+}
+
+template<size_t N>
+void bm_static_union_find_small(benchmark::State& state)
+{
+    run_small_union_find<static_union_find<unsigned, N>>(state, N);
+}
+
+// =================================================================================================
+/// Steady growth from 1Ki to nelems elements by 64Ki at a time, with random joins in between.
+/// The label shows the longest single resize.
+template<template<typename...> class container>
+void bm_union_find_growth(benchmark::State& state)
+{
+    const unsigned nelems = state.range(0);
+    const unsigned step = 1 << 16;
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::chrono::steady_clock::duration maxResize {};
+
+    perf_scope perf(state, nelems);
+    while (state.KeepRunning())
+    {
+        union_find<unsigned, container> uf(1024);
+        while (uf.size() < nelems)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            uf.resize(std::min(uf.size() + step, nelems));
+            maxResize = std::max(maxResize, std::chrono::steady_clock::now() - start);
+
+            std::uniform_int_distribution<unsigned> dist(0, uf.max_value());
+            for (unsigned i = 0; i < step / 16; ++i)
+                uf.join(dist(gen), dist(gen));
+        }
+    }
+
+    state.SetLabel("max resize " + std::to_string(
+                std::chrono::duration_cast<std::chrono::microseconds>(maxResize).count()) + " us");
+}
+
+// =================================================================================================
+/// Edges of a graph of communities with power-law sizes (exponent 2, at most nelems/10 elements),
+/// 90% of the edges inside a community, and element values scattered by a random permutation so
+/// that communities are not contiguous.
+std::vector<std::pair<unsigned, unsigned>> skewed_edges(unsigned nelems, size_t nedges)
+{
+    std::mt19937 gen(36);
+
+    std::vector<unsigned> scatter(nelems);
+    std::iota(scatter.begin(), scatter.end(), 0);
+    std::shuffle(scatter.begin(), scatter.end(), gen);
+
+    // community c is [begin[c], begin[c+1]) before scattering
+    std::vector<unsigned> begin {0};
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    while (begin.back() < nelems)
+    {
+        const double size = std::min(1.0 / (1.0 - unit(gen)), nelems / 10.0);
+        begin.push_back(std::min<unsigned>(nelems, begin.back() + static_cast<unsigned>(size)));
+    }
+
+    std::uniform_int_distribution<unsigned> element(0, nelems - 1);
+    std::vector<std::pair<unsigned, unsigned>> edges;
+    edges.reserve(nedges);
+    while (edges.size() < nedges)
+    {
+        // communities are picked by element, big communities get proportionally more edges
+        const unsigned v1 = element(gen);
+        unsigned v2 = element(gen);
+        if (unit(gen) < 0.9)
+        {
+            const auto c = std::upper_bound(begin.begin(), begin.end(), v1) - begin.begin() - 1;
+            v2 = begin[c] + v2 % (begin[c + 1] - begin[c]);
+        }
+        edges.emplace_back(scatter[v1], scatter[v2]);
+    }
+
+    return edges;
+}
+
+/// Joins the edges of skewed_edges() in a fresh union-find per iteration. The first 5% of the
+/// edges are the sample for locality_order(), which is computed outside the measured loop.
+template<typename union_find_type, typename make_function>
+void run_skewed(benchmark::State& state, make_function make)
+{
+    const unsigned nelems = state.range(0);
+    const auto edges = skewed_edges(nelems, 2 * size_t(nelems));
+    const auto order = locality_order<unsigned>(nelems, edges.begin(), edges.begin() + edges.size() / 20);
+
+    perf_scope perf(state, edges.size());
+    while (state.KeepRunning())
+    {
+        state.PauseTiming();
+        union_find_type uf = make(nelems, order);
+        state.ResumeTiming();
+
+        for (const auto& edge : edges)
+            uf.join(edge.first, edge.second);
+        benchmark::DoNotOptimize(uf.find(0));
+    }
+}
+
+void bm_union_find_skewed(benchmark::State& state)
+{
+    run_skewed<union_find<unsigned>>(state, [](unsigned n, const std::vector<unsigned>&)
+        { return union_find<unsigned>(n); });
+}
+
+void bm_hash_linked_union_find_skewed(benchmark::State& state)
+{
+    run_skewed<hash_linked_union_find<unsigned>>(state, [](unsigned n, const std::vector<unsigned>&)
+        { return hash_linked_union_find<unsigned>(n); });
+}
+
+template<typename union_find_type>
+void bm_relabeled_union_find_skewed(benchmark::State& state)
+{
+    run_skewed<relabeled_union_find<union_find_type>>(state, [](unsigned, const std::vector<unsigned>& order)
+        { return relabeled_union_find<union_find_type>(order); });
+}
+
+// =================================================================================================
+/// union_find with the counting loop before the vectorized kernels, for comparison
+class union_find_element_count
+    : public union_find<unsigned>
+{
+    public:
+        using union_find::union_find;
+
+        size_type count_disjoint_loop() const
+        {
+            size_type roots = 0;
+            for (value_type value = 0; value < size(); ++value)
+            {
+                if (is_root(value))
+                    ++roots;
+            }
+            return roots;
+        }
+};
+
+/// Counts the sets after n/4 random joins, range(1) selects element loop (-1), vectorized (0) or
+/// vectorized on range(1) threads
+void bm_union_find_count_disjoint(benchmark::State& state)
+{
+    const unsigned nelems = state.range(0);
+    const int threads = state.range(1);
+    union_find_element_count uf(nelems);
+
+    std::mt19937 gen(39);
+    std::uniform_int_distribution<unsigned> dist(0, nelems-1);
+    for (unsigned i = 0; i < nelems / 4; ++i)
+        uf.join(dist(gen), dist(gen));
+
+    perf_scope perf(state, nelems);
+    while (state.KeepRunning())
+    {
+        if (threads < 0)
+            benchmark::DoNotOptimize(uf.count_disjoint_loop());
+        else if (threads == 0)
+            benchmark::DoNotOptimize(uf.count_disjoint());
+        else
+            benchmark::DoNotOptimize(uf.count_disjoint(threads));
+    }
+    state.SetBytesProcessed(state.iterations() * int64_t(nelems) * sizeof(unsigned));
+}
+
+// =================================================================================================
+/// Minimum spanning forest of nelems nodes and 4 * nelems random edges by Kruskal's algorithm, as a
+/// Kruskal reconstruction tree and as adjacency lists (compressed sparse row) of the forest edges
+struct bottleneck_graph
+{
+    bottleneck_graph(unsigned nelems)
+        : tree(nelems)
+        , offsets(nelems + 1, 0)
+    {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<unsigned> dist(0, nelems-1);
+        std::vector<std::tuple<unsigned, unsigned, unsigned>> edges(4 * size_t(nelems));
+        for (auto& edge : edges)
+            edge = std::make_tuple(dist(gen), dist(gen), dist(gen));
+        std::sort(edges.begin(), edges.end());
+
+        std::vector<std::tuple<unsigned, unsigned, unsigned>> forest;
+        for (const auto& edge : edges)
+        {
+            if (tree.join(std::get<1>(edge), std::get<2>(edge), std::get<0>(edge)))
+                forest.push_back(edge);
+        }
+
+        for (const auto& edge : forest)
+        {
+            ++offsets[std::get<1>(edge) + 1];
+            ++offsets[std::get<2>(edge) + 1];
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        adjacent.resize(offsets.back());
+        std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+        for (const auto& edge : forest)
+        {
+            adjacent[fill[std::get<1>(edge)]++] = {std::get<2>(edge), std::get<0>(edge)};
+            adjacent[fill[std::get<2>(edge)]++] = {std::get<1>(edge), std::get<0>(edge)};
+        }
+
+        queries.resize(1000000);
+        for (auto& query : queries)
+            query = {dist(gen), dist(gen)};
+    }
+
+    /// The per query baseline: breadth first search from a over the forest, tracking the largest
+    /// weight on the path to every reached node
+    unsigned bfs_bottleneck(unsigned a, unsigned b, std::vector<unsigned>& bottleneck, std::vector<unsigned>& queue) const
+    {
+        const unsigned unreached = ~0u;
+        std::fill(bottleneck.begin(), bottleneck.end(), unreached);
+        queue.clear();
+        queue.push_back(a);
+        bottleneck[a] = 0;
+        for (size_t head = 0; head < queue.size() && bottleneck[b] == unreached; ++head)
+        {
+            const unsigned v = queue[head];
+            for (size_t e = offsets[v]; e < offsets[v + 1]; ++e)
+            {
+                const auto& next = adjacent[e];
+                if (bottleneck[next.first] == unreached)
+                {
+                    bottleneck[next.first] = std::max(bottleneck[v], next.second);
+                    queue.push_back(next.first);
+                }
+            }
+        }
+        return bottleneck[b];
+    }
+
+    kruskal_tree<unsigned, unsigned> tree;
+    std::vector<size_t> offsets;
+    std::vector<std::pair<unsigned, unsigned>> adjacent; // node and edge weight
+    std::vector<std::pair<unsigned, unsigned>> queries;
+};
+
+/// 1M bottleneck queries answered in one batch by offline Tarjan LCA
+void bm_kruskal_tree_bottleneck_batch(benchmark::State& state)
+{
+    const bottleneck_graph graph(state.range(0));
+    std::vector<unsigned> results(graph.queries.size());
+
+    perf_scope perf(state, graph.queries.size());
+    while (state.KeepRunning())
+    {
+        graph.tree.bottleneck_batch(graph.queries.begin(), graph.queries.end(), results.begin(), ~0u);
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(state.iterations() * graph.queries.size());
+}
+
+/// The same queries by one breadth first search each, 100 per iteration
+void bm_mst_bfs_bottleneck(benchmark::State& state)
+{
+    const bottleneck_graph graph(state.range(0));
+    std::vector<unsigned> bottleneck(state.range(0)), queue;
+    const size_t queries = 100;
+
+    perf_scope perf(state, queries);
+    while (state.KeepRunning())
+    {
+        for (size_t q = 0; q < queries; ++q)
+            benchmark::DoNotOptimize(graph.bfs_bottleneck(graph.queries[q].first, graph.queries[q].second, bottleneck, queue));
+    }
+    state.SetItemsProcessed(state.iterations() * queries);
+}
+
+// =================================================================================================
+/// Edge log slice of one shard: range(2) random edges over range(0) elements
+std::vector<std::pair<unsigned, unsigned>> shard_edges(unsigned nelems, size_t nedges, unsigned shard)
+{
+    std::mt19937 gen(1000 + shard);
+    std::uniform_int_distribution<unsigned> dist(0, nelems-1);
+    std::vector<std::pair<unsigned, unsigned>> edges(nedges);
+    for (auto& edge : edges)
+        edge = {dist(gen), dist(gen)};
+    return edges;
+}
+
+/// range(1) shards each join their slice of the edge log and send a root map, which are reduced
+/// pairwise in a tree: every inner node decodes one map with from_root_map(), merges the other and
+/// sends its root map up. Shards are built before the measurement, one at a time, and consumed by
+/// the single iteration. The label shows the critical path, the sum of the slowest node per level,
+/// with one worker per node.
+void bm_union_find_shard_reduction(benchmark::State& state)
+{
+    const unsigned nelems = state.range(0);
+    const unsigned nshards = state.range(1);
+    const size_t edgesPerShard = state.range(2);
+
+    std::vector<std::vector<uint8_t>> shardMaps;
+    size_t shardBytes = 0;
+    for (unsigned shard = 0; shard < nshards; ++shard)
+    {
+        union_find<unsigned> uf(nelems);
+        for (const auto& edge : shard_edges(nelems, edgesPerShard, shard))
+            uf.join(edge.first, edge.second);
+        shardMaps.push_back(uf.root_map());
+        shardBytes += shardMaps.back().size();
+    }
+
+    size_t sets = 0, mapBytes = 0;
+    std::chrono::steady_clock::duration criticalPath {};
+    perf_scope perf(state, nelems);
+    while (state.KeepRunning())
+    {
+        auto maps = std::move(shardMaps);
+        while (maps.size() > 1)
+        {
+            std::vector<std::vector<uint8_t>> reduced;
+            std::chrono::steady_clock::duration slowest {};
+            for (size_t i = 0; i < maps.size(); i += 2)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                auto uf = union_find<unsigned>::from_root_map(maps[i]);
+                if (i + 1 < maps.size())
+                    uf.merge_root_map(maps[i + 1]);
+                reduced.push_back(uf.root_map());
+                slowest = std::max(slowest, std::chrono::steady_clock::now() - start);
+            }
+            maps.swap(reduced);
+            criticalPath += slowest;
+        }
+
+        sets = union_find<unsigned>::from_root_map(maps.front()).count_disjoint();
+        mapBytes = maps.front().size();
+    }
+
+    state.SetLabel(std::to_string(sets) + " sets, shard maps " + std::to_string(shardBytes >> 20) +
+            " MiB, final " + std::to_string(mapBytes >> 20) + " MiB, critical path " +
+            std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(criticalPath).count()) + " ms");
+}
+
+/// The baseline: one union_find replays the edge log of all shards, generated slice by slice in
+/// the measured loop (as reading the log would be)
+void bm_union_find_edge_replay(benchmark::State& state)
+{
+    const unsigned nelems = state.range(0);
+    const unsigned nshards = state.range(1);
+    const size_t edgesPerShard = state.range(2);
+
+    size_t sets = 0;
+    perf_scope perf(state, nelems);
+    while (state.KeepRunning())
+    {
+        union_find<unsigned> uf(nelems);
+        for (unsigned shard = 0; shard < nshards; ++shard)
+        {
+            for (const auto& edge : shard_edges(nelems, edgesPerShard, shard))
+                uf.join(edge.first, edge.second);
+        }
+        sets = uf.count_disjoint();
+    }
+
+    state.SetLabel(std::to_string(sets) + " sets");
+}
+
 // =================================================================================================
 BENCHMARK(bm_union_find)->Arg(100)->Arg(1000)->Arg(10000)->Arg(100000)->Arg(1000000);
+BENCHMARK(bm_enumerable_union_find)->Arg(100)->Arg(1000)->Arg(10000)->Arg(100000)->Arg(1000000);
+BENCHMARK(bm_weighted_union_find)->Arg(100)->Arg(1000)->Arg(10000)->Arg(100000)->Arg(1000000);
+
+BENCHMARK_TEMPLATE(bm_union_find_sparse_find, union_find<uint64_t>)->Arg(1000000)->Arg(100000000);
+BENCHMARK_TEMPLATE(bm_union_find_sparse_find, compact_union_find<>)->Arg(1000000)->Arg(100000000);
+
+BENCHMARK(bm_union_find_find_loop)->Arg(1000000)->Arg(100000000);
+BENCHMARK(bm_union_find_find_batch)->Arg(1000000)->Arg(100000000);
+
+BENCHMARK(bm_union_find_small)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK_TEMPLATE(bm_static_union_find_small, 16);
+BENCHMARK_TEMPLATE(bm_static_union_find_small, 64);
+BENCHMARK_TEMPLATE(bm_static_union_find_small, 256);
+
+BENCHMARK_TEMPLATE(bm_union_find_growth, std::vector)->Arg(1 << 20)->Arg(1 << 24)->Arg(1 << 27)->Arg(1 << 30)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(bm_union_find_growth, segmented_vector)->Arg(1 << 20)->Arg(1 << 24)->Arg(1 << 27)->Arg(1 << 30)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_union_find_members_scan)->Arg(1 << 20)->Arg(1 << 24)->Unit(benchmark::kMicrosecond);
+BENCHMARK(bm_enumerable_union_find_members)->Arg(1 << 20)->Arg(1 << 24)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(bm_union_find_skewed)->Arg(1 << 20)->Arg(1 << 24)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_hash_linked_union_find_skewed)->Arg(1 << 20)->Arg(1 << 24)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(bm_relabeled_union_find_skewed, union_find<unsigned>)->Arg(1 << 20)->Arg(1 << 24)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(bm_relabeled_union_find_skewed, hash_linked_union_find<unsigned>)->Arg(1 << 20)->Arg(1 << 24)->Unit(benchmark::kMillisecond);
+
+BENCHMARK(bm_union_find_count_disjoint)->ArgsProduct({{1 << 20, 1 << 24, 1 << 27}, {-1, 0, 2, 4}})
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK(bm_kruskal_tree_bottleneck_batch)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 24)->Unit(benchmark::kMillisecond);
+BENCHMARK(bm_mst_bfs_bottleneck)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 24)->Unit(benchmark::kMillisecond);
 
-BENCHMARK_MAIN()
+BENCHMARK(bm_union_find_shard_reduction)->Args({1 << 20, 64, 10000})->Args({100000000, 64, 1000000})
+    ->Args({100000000, 64, 4000000})->Unit(benchmark::kMillisecond)->Iterations(1);
+BENCHMARK(bm_union_find_edge_replay)->Args({1 << 20, 64, 10000})->Args({100000000, 64, 1000000})
+    ->Args({100000000, 64, 4000000})->Unit(benchmark::kMillisecond)->Iterations(1);
 
+BENCHMARK_MAIN();
@@ -0,0 +1,945 @@
+/// Differential fuzzing of all queue and union-find variants.
+///
+/// Every round applies random operation sequences to each variant and to a naive reference model,
+/// compares all results and validates the internal invariants (heap order, heap index, bucket
+/// lists, parent forest and subtree sizes) after every single step.
+///
+/// usage: fuzz_containers [seed [rounds]]
+///
+/// Round r uses the seed `seed + r`, a failure reports it so `fuzz_containers <seed> 1` replays
+/// only the failing round.
+
+#include <bucket_queue.hpp>
+#include <compact_union_find.hpp>
+#include <enumerable_union_find.hpp>
+#include <indexed_heap.hpp>
+#include <lazy_indexed_heap.hpp>
+#include <locality_union_find.hpp>
+#include <segmented_vector.hpp>
+#include <static_indexed_heap.hpp>
+#include <static_union_find.hpp>
+#include <streaming_components.hpp>
+#include <union_find.hpp>
+#include <weighted_union_find.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    struct fuzz_failure
+        : std::runtime_error
+    {
+        using std::runtime_error::runtime_error;
+    };
+
+    void check(bool condition, const char* what)
+    {
+        if (!condition)
+            throw fuzz_failure(what);
+    }
+
+    template<typename Function>
+    void check_out_of_range(Function fn, const char* what)
+    {
+        try
+        {
+            fn();
+        }
+        catch (const std::out_of_range&)
+        {
+            return;
+        }
+        throw fuzz_failure(std::string(what) + " did not throw std::out_of_range");
+    }
+
+    size_t random_below(std::mt19937& gen, size_t n)
+    {
+        return std::uniform_int_distribution<size_t>(0, n - 1)(gen);
+    }
+
+    // =============================================================================================
+    // reference models
+
+    /// Priorities and values of the queued elements, every query is a linear scan
+    class naive_queue
+    {
+        public:
+            static constexpr int noValue = -1; // pushed without a value
+
+            naive_queue(size_t itemCount)
+                : mPrio(itemCount)
+                , mValue(itemCount)
+                , mQueued(itemCount, false)
+            {}
+
+            size_t element_count() const
+            { return mQueued.size(); }
+
+            size_t size() const
+            { return mSize; }
+
+            bool queued(size_t elem) const
+            { return mQueued[elem]; }
+
+            int priority(size_t elem) const
+            { return mPrio[elem]; }
+
+            int value(size_t elem) const
+            { return mValue[elem]; }
+
+            int min_priority() const
+            {
+                int result = 0;
+                bool found = false;
+                for (size_t elem = 0; elem < mQueued.size(); ++elem)
+                {
+                    if (mQueued[elem] && (!found || mPrio[elem] < result))
+                    {
+                        result = mPrio[elem];
+                        found = true;
+                    }
+                }
+                return result;
+            }
+
+            bool push(size_t elem, int priority, int value = noValue)
+            {
+                if (mQueued[elem])
+                    return false;
+                mQueued[elem] = true;
+                mPrio[elem] = priority;
+                mValue[elem] = value;
+                ++mSize;
+                return true;
+            }
+
+            bool change_priority(size_t elem, int priority)
+            {
+                if (!mQueued[elem])
+                    return false;
+                mPrio[elem] = priority;
+                return true;
+            }
+
+            void remove(size_t elem)
+            {
+                mQueued[elem] = false;
+                --mSize;
+            }
+
+            void reserve(size_t itemCount)
+            {
+                mPrio.resize(itemCount);
+                mValue.resize(itemCount);
+                mQueued.resize(itemCount, false);
+            }
+
+        private:
+            std::vector<int> mPrio;
+            std::vector<int> mValue;
+            std::vector<bool> mQueued;
+            size_t mSize = 0;
+    };
+
+    bool has_value(const std::unique_ptr<int>& value, int expected)
+    {
+        return value ? *value == expected : expected == naive_queue::noValue;
+    }
+
+    /// Set label and potential by element, a join relabels and shifts a whole set
+    class naive_sets
+    {
+        public:
+            naive_sets(size_t n)
+            { resize(n); }
+
+            size_t size() const
+            { return mLabel.size(); }
+
+            void resize(size_t n)
+            {
+                const size_t origSize = mLabel.size();
+                mLabel.resize(n);
+                mPotential.resize(n, 0);
+                std::iota(mLabel.begin() + origSize, mLabel.end(), origSize);
+            }
+
+            bool same_set(size_t v1, size_t v2) const
+            { return mLabel[v1] == mLabel[v2]; }
+
+            long potential(size_t value) const
+            { return mPotential[value]; }
+
+            /// potential(v2) - potential(v1) == delta afterwards, unless already in the same set
+            bool join(size_t v1, size_t v2, long delta = 0)
+            {
+                const size_t from = mLabel[v2];
+                const size_t to = mLabel[v1];
+                if (from == to)
+                    return false;
+
+                const long shift = mPotential[v1] + delta - mPotential[v2];
+                for (size_t value = 0; value < mLabel.size(); ++value)
+                {
+                    if (mLabel[value] == from)
+                    {
+                        mLabel[value] = to;
+                        mPotential[value] += shift;
+                    }
+                }
+                return true;
+            }
+
+            std::vector<size_t> members(size_t value) const
+            {
+                std::vector<size_t> result;
+                for (size_t member = 0; member < mLabel.size(); ++member)
+                {
+                    if (mLabel[member] == mLabel[value])
+                        result.push_back(member);
+                }
+                return result;
+            }
+
+            size_t count_disjoint() const
+            {
+                size_t sets = 0;
+                for (size_t value = 0; value < mLabel.size(); ++value)
+                {
+                    if (mLabel[value] == value)
+                        ++sets;
+                }
+                return sets;
+            }
+
+            size_t count_singleton() const
+            {
+                std::vector<size_t> members(mLabel.size(), 0);
+                for (const auto label : mLabel)
+                    ++members[label];
+                return static_cast<size_t>(std::count(members.begin(), members.end(), size_t(1)));
+            }
+
+        private:
+            std::vector<size_t> mLabel;
+            std::vector<long> mPotential;
+    };
+
+    // =============================================================================================
+    // invariant checks through the protected internals
+
+    template<typename heap_type>
+    class checked_heap
+        : public heap_type
+    {
+        public:
+            using heap_type::heap_type;
+
+            void check_invariants() const
+            {
+                const auto& heap = this->mHeap;
+                const auto& index = this->mIndex;
+
+                for (size_t i = 0; i < heap.size(); ++i)
+                {
+                    check(i == 0 || !(heap[i].prio < heap[(i - 1) / 2].prio), "heap order violated");
+                    check(heap[i].elem < index.size() && index[heap[i].elem] == i, "mIndex does not match mHeap");
+                }
+
+                size_t queued = 0;
+                for (size_t elem = 0; elem < index.size(); ++elem)
+                {
+                    if (index[elem] == this->invalidIndex)
+                        continue;
+                    check(index[elem] < heap.size() && heap[index[elem]].elem == elem, "mIndex points to another element");
+                    ++queued;
+                }
+                check(queued == heap.size(), "mIndex and mHeap differ in size");
+            }
+    };
+
+    template<typename heap_type>
+    class checked_static_heap
+        : public heap_type
+    {
+        public:
+            using heap_type::heap_type;
+
+            void check_invariants() const
+            {
+                for (size_t i = 0; i < this->mSize; ++i)
+                {
+                    const auto& item = this->mHeap[i];
+                    check(i == 0 || !(item.prio < this->mHeap[(i - 1) / 2].prio), "heap order violated");
+                    check(item.elem < this->mItemCount && this->mIndex[item.elem] == i, "mIndex does not match mHeap");
+                }
+
+                size_t queued = 0;
+                for (size_t elem = 0; elem < this->mItemCount; ++elem)
+                {
+                    const auto idx = this->mIndex[elem];
+                    if (idx == heap_type::invalidIndex)
+                        continue;
+                    check(idx < this->mSize && this->mHeap[idx].elem == elem, "mIndex points to another element");
+                    ++queued;
+                }
+                check(queued == this->mSize, "mIndex and mHeap differ in size");
+            }
+    };
+
+    template<typename queue_type>
+    class checked_buckets
+        : public queue_type
+    {
+        public:
+            using queue_type::queue_type;
+
+            void check_invariants() const
+            {
+                size_t queued = 0;
+                size_t minBucket = this->mBucketCount;
+
+                for (size_t bucket = 0; bucket < this->mBucketCount; ++bucket)
+                {
+                    const auto head = this->sentinel(bucket);
+                    check(this->mNext[this->mPrev[head]] == head, "bucket list not linked");
+                    for (auto node = this->mNext[head]; node != head; node = this->mNext[node])
+                    {
+                        check(node < this->mItemCount, "element list links to a sentinel");
+                        check(this->mPrev[this->mNext[node]] == node, "bucket list not linked");
+                        check(static_cast<size_t>(this->mPrio[node]) == bucket, "element in the wrong bucket");
+                        if (minBucket == this->mBucketCount)
+                            minBucket = bucket;
+                        check(++queued <= this->mSize, "bucket lists hold more than size() elements");
+                    }
+                }
+
+                check(queued == this->mSize, "bucket lists hold less than size() elements");
+                check(this->mMinBucket <= minBucket, "mMinBucket is above the lowest non-empty bucket");
+            }
+    };
+
+    template<typename T, typename = void>
+    struct has_link_priority : std::false_type {};
+
+    template<typename T>
+    struct has_link_priority<T, std::void_t<decltype(T::link_priority(0))>> : std::true_type {};
+
+    /// Parents stay in range without cycles and subtree_size() is one plus the subtree sizes of the
+    /// children. With union by size no tree is deeper than log2 of its size, with hash linking
+    /// every parent has a higher link priority than its children.
+    template<typename sets_type>
+    class checked_sets
+        : public sets_type
+    {
+        public:
+            using sets_type::sets_type;
+
+            void check_invariants(bool bySize) const
+            {
+                using value_type = typename sets_type::value_type;
+
+                const size_t n = this->size();
+                std::vector<size_t> depth(n, 0);
+                std::vector<size_t> treeDepth(n, 0); // by root
+                for (size_t value = 0; value < n; ++value)
+                {
+                    auto node = static_cast<value_type>(value);
+                    while (this->parent(node) != node)
+                    {
+                        check(static_cast<size_t>(this->parent(node)) < n, "parent out of range");
+                        if constexpr (has_link_priority<sets_type>::value)
+                            check(sets_type::link_priority(this->parent(node)) > sets_type::link_priority(node),
+                                    "parent of lower link priority");
+                        check(++depth[value] < n, "cycle in the parent forest");
+                        node = this->parent(node);
+                    }
+                    treeDepth[node] = std::max(treeDepth[node], depth[value]);
+                }
+
+                // children before parents
+                std::vector<size_t> order(n);
+                std::iota(order.begin(), order.end(), 0);
+                std::sort(order.begin(), order.end(), [&depth](size_t a, size_t b) { return depth[a] > depth[b]; });
+
+                std::vector<size_t> subtree(n, 1);
+                for (const auto value : order)
+                {
+                    const auto v = static_cast<value_type>(value);
+                    check(static_cast<size_t>(this->subtree_size(v)) == subtree[value], "mSize is not the subtree size");
+                    if (this->parent(v) != v)
+                        subtree[this->parent(v)] += subtree[value];
+                    else if (bySize)
+                        check(size_t(1) << treeDepth[value] <= subtree[value], "tree deeper than log2(size)");
+                }
+            }
+    };
+
+    // =============================================================================================
+    // optional members
+
+    template<typename T, typename = void>
+    struct has_reserve_elements : std::false_type {};
+
+    template<typename T>
+    struct has_reserve_elements<T, std::void_t<decltype(std::declval<T&>().reserve_elements(1))>> : std::true_type {};
+
+    template<typename T, typename = void>
+    struct has_payload : std::false_type {};
+
+    template<typename T>
+    struct has_payload<T, std::void_t<decltype(std::declval<T&>().value(0))>> : std::true_type {};
+
+    template<typename T, typename = void>
+    struct has_resize : std::false_type {};
+
+    template<typename T>
+    struct has_resize<T, std::void_t<decltype(std::declval<T&>().resize(1))>> : std::true_type {};
+
+    template<typename T, typename = void>
+    struct has_root_map : std::false_type {};
+
+    template<typename T>
+    struct has_root_map<T, std::void_t<decltype(T::from_root_map(std::declval<const T&>().root_map()))>> : std::true_type {};
+
+    template<typename T, typename = void>
+    struct has_find_batch : std::false_type {};
+
+    template<typename T>
+    struct has_find_batch<T, std::void_t<decltype(std::declval<const T&>().find_batch(
+            std::declval<unsigned*>(), std::declval<unsigned*>(), std::declval<unsigned*>()))>> : std::true_type {};
+
+    template<typename T, typename = void>
+    struct has_members : std::false_type {};
+
+    template<typename T>
+    struct has_members<T, std::void_t<decltype(std::declval<const T&>().members(0))>> : std::true_type {};
+
+    template<typename T, typename = void>
+    struct has_count_singleton : std::false_type {};
+
+    template<typename T>
+    struct has_count_singleton<T, std::void_t<decltype(std::declval<const T&>().count_singleton())>> : std::true_type {};
+
+    template<typename T, typename = void>
+    struct has_invariants : std::false_type {};
+
+    template<typename T>
+    struct has_invariants<T, std::void_t<decltype(std::declval<const T&>().check_invariants(true))>> : std::true_type {};
+
+    /// Runs the steps of a variant, failures are reported with the variant and the step
+    template<typename Function>
+    void run_steps(const std::string& name, size_t steps, Function step)
+    {
+        size_t i = 0;
+        try
+        {
+            for (; i < steps; ++i)
+                step();
+        }
+        catch (const std::exception& e)
+        {
+            throw fuzz_failure(name + ", step " + std::to_string(i) + ": " + e.what());
+        }
+    }
+
+    // =============================================================================================
+    // queues
+
+    /// Random pushes, priority changes and pops with priorities in [minPrio, maxPrio], priorities
+    /// above validPrio must be rejected with std::out_of_range.
+    template<typename queue_type>
+    void run_queue(const std::string& name, queue_type& q, size_t itemCount,
+            int minPrio, int maxPrio, int validPrio, std::mt19937& gen, size_t steps)
+    {
+        naive_queue model(itemCount);
+        std::uniform_int_distribution<int> prios(minPrio, maxPrio);
+
+        run_steps(name, steps, [&]
+        {
+            // one past the last element to hit the range checks
+            const size_t elem = random_below(gen, model.element_count() + 1);
+            const auto e = static_cast<unsigned short>(elem);
+            const int prio = prios(gen);
+            const int value = static_cast<int>(random_below(gen, 1000));
+            const bool inRange = elem < model.element_count();
+            const bool queued = inRange && model.queued(elem);
+            const bool prioOk = prio <= validPrio;
+
+            switch (gen() % 10)
+            {
+                case 0: case 1: case 2:
+                    if (!inRange || (!prioOk && !queued))
+                    {
+                        check_out_of_range([&] { q.push(e, prio); }, "push()");
+                        break;
+                    }
+                    if constexpr (has_payload<queue_type>::value)
+                        check(q.push(e, prio, std::make_unique<int>(value)) == model.push(elem, prio, value), "push() result");
+                    else
+                        check(q.push(e, prio) == model.push(elem, prio), "push() result");
+                    break;
+
+                case 3: case 4:
+                    if (!inRange || (!prioOk && queued))
+                        check_out_of_range([&] { q.change_priority(e, prio); }, "change_priority()");
+                    else
+                        check(q.change_priority(e, prio) == model.change_priority(elem, prio), "change_priority() result");
+                    break;
+
+                case 5:
+                    if (!inRange || !prioOk)
+                    {
+                        check_out_of_range([&] { q.set_priority(e, prio); }, "set_priority()");
+                        break;
+                    }
+                    q.set_priority(e, prio);
+                    if (!model.change_priority(elem, prio))
+                        model.push(elem, prio);
+                    break;
+
+                case 6: case 7:
+                    if (model.size() == 0)
+                    {
+                        q.pop();
+                        check_out_of_range([&] { q.top(); }, "top() of an empty queue");
+                        break;
+                    }
+                    {
+                        const auto top = q.top();
+                        check(top < model.element_count() && model.queued(top), "top() is not queued");
+                        check(q.top_priority() == model.min_priority(), "top_priority() is not the minimum");
+                        check(model.priority(top) == model.min_priority(), "priority of top() is not the minimum");
+
+                        if constexpr (has_payload<queue_type>::value)
+                        {
+                            if (gen() % 2)
+                            {
+                                const auto popped = q.pop_with_value();
+                                check(has_value(popped, model.value(top)), "pop_with_value() returned the wrong value");
+                                model.remove(top);
+                                break;
+                            }
+                        }
+                        q.pop();
+                        model.remove(top);
+                    }
+                    break;
+
+                case 8:
+                    if (!queued)
+                    {
+                        check_out_of_range([&] { q.get_priority(e); }, "get_priority() of an element not queued");
+                        if constexpr (has_payload<queue_type>::value)
+                            check_out_of_range([&] { q.value(e); }, "value() of an element not queued");
+                        break;
+                    }
+                    check(q.get_priority(e) == model.priority(elem), "get_priority() result");
+                    if constexpr (has_payload<queue_type>::value)
+                        check(has_value(q.value(e), model.value(elem)), "value() result");
+                    break;
+
+                case 9:
+                    if constexpr (has_reserve_elements<queue_type>::value)
+                    {
+                        const size_t grown = model.element_count() + random_below(gen, 9);
+                        q.reserve_elements(grown);
+                        model.reserve(grown);
+                        check(q.element_count() == grown, "element_count() after reserve_elements()");
+                    }
+                    break;
+            }
+
+            q.check_invariants();
+            check(q.size() == model.size(), "size() differs");
+            check(q.empty() == (model.size() == 0), "empty() differs");
+            // not after every step, top_priority() applies the pending updates of lazy_indexed_heap
+            if (model.size() > 0 && gen() % 4 == 0)
+                check(q.top_priority() == model.min_priority(), "top_priority() is not the minimum");
+        });
+    }
+
+    void fuzz_queues(std::mt19937& gen, size_t n, size_t steps)
+    {
+        const int maxPrio = static_cast<int>(gen() % 2 ? 8 : 1000); // many or few equal priorities
+
+        {
+            checked_heap<indexed_heap<unsigned short, int>> q(static_cast<unsigned short>(n));
+            run_queue("indexed_heap", q, n, -maxPrio, maxPrio, maxPrio, gen, steps);
+        }
+        {
+            checked_heap<indexed_heap<unsigned short, int, std::unique_ptr<int>>> q(static_cast<unsigned short>(n));
+            run_queue("indexed_heap with payload", q, n, -maxPrio, maxPrio, maxPrio, gen, steps);
+        }
+        {
+            checked_heap<indexed_heap<unsigned short, int, void, segmented_vector>> q(static_cast<unsigned short>(n));
+            run_queue("indexed_heap<segmented_vector>", q, n, -maxPrio, maxPrio, maxPrio, gen, steps);
+        }
+        {
+            // at most 1000 + 300 * 8 elements with the growth, within uint16_t
+            checked_heap<indexed_heap<uint64_t, int, void, std::vector, uint16_t>> q(n);
+            run_queue("indexed_heap<uint64_t> with uint16_t index", q, n, -maxPrio, maxPrio, maxPrio, gen, steps);
+        }
+        {
+            checked_heap<lazy_indexed_heap<unsigned short, int>> q(static_cast<unsigned short>(n));
+            run_queue("lazy_indexed_heap", q, n, -maxPrio, maxPrio, maxPrio, gen, steps);
+        }
+        {
+            const size_t count = std::min<size_t>(n, 64);
+            checked_static_heap<static_indexed_heap<unsigned short, int, 64>> q(count);
+            run_queue("static_indexed_heap", q, count, -maxPrio, maxPrio, maxPrio, gen, steps);
+        }
+        {
+            const int buckets = 1 + static_cast<int>(random_below(gen, 32));
+            checked_buckets<bucket_queue<unsigned short, int>> q(static_cast<unsigned short>(n), buckets);
+            run_queue("bucket_queue", q, n, 0, buckets, buckets - 1, gen, steps);
+        }
+    }
+
+    // =============================================================================================
+    // union-finds
+
+    template<typename sets_type>
+    void check_sets(const sets_type& uf, const naive_sets& model, bool bySize)
+    {
+        if constexpr (has_invariants<sets_type>::value)
+            uf.check_invariants(bySize);
+
+        check(static_cast<size_t>(uf.size()) == model.size(), "size() differs");
+        check(static_cast<size_t>(uf.count_disjoint()) == model.count_disjoint(), "count_disjoint() differs");
+        if constexpr (has_count_singleton<sets_type>::value)
+            check(static_cast<size_t>(uf.count_singleton()) == model.count_singleton(), "count_singleton() differs");
+    }
+
+    /// Random joins, finds and batch queries, bySize enables the depth check of union by size
+    template<typename sets_type>
+    void run_sets(const std::string& name, sets_type& uf, size_t n, bool bySize, std::mt19937& gen, size_t steps)
+    {
+        using value_type = typename sets_type::value_type;
+        naive_sets model(n);
+        const sets_type& cuf = uf;
+
+        run_steps(name, steps, [&]
+        {
+            // one past the last value to hit the range checks
+            const size_t v1 = random_below(gen, model.size() + 1);
+            const size_t v2 = random_below(gen, model.size() + 1);
+            const auto a = static_cast<value_type>(v1);
+            const auto b = static_cast<value_type>(v2);
+            const bool inRange = v1 < model.size() && v2 < model.size();
+
+            switch (gen() % 8)
+            {
+                case 0: case 1: case 2:
+                    if (!inRange)
+                        check_out_of_range([&] { uf.join(a, b); }, "join()");
+                    else
+                        check(uf.join(a, b) == model.join(v1, v2), "join() result");
+                    break;
+
+                case 3:
+                    if (!inRange)
+                    {
+                        check_out_of_range([&] { uf.find(a); uf.find(b); }, "find()");
+                        break;
+                    }
+                    check((uf.find(a) == uf.find(b)) == model.same_set(v1, v2), "find() disagrees on the partition");
+                    check(uf.find(uf.find(a)) == uf.find(a), "find() of a root is not the root");
+                    break;
+
+                case 4:
+                    if (!inRange)
+                    {
+                        check_out_of_range([&] { cuf.find(a); cuf.find(b); }, "const find()");
+                        break;
+                    }
+                    check((cuf.find(a) == cuf.find(b)) == model.same_set(v1, v2), "const find() disagrees on the partition");
+                    check(cuf.find(a) == uf.find(a), "const find() differs from find()");
+                    break;
+
+                case 5:
+                    if constexpr (has_find_batch<sets_type>::value)
+                    {
+                        const size_t count = random_below(gen, 80);
+                        std::vector<value_type> first(count);
+                        std::vector<value_type> second(count);
+                        for (size_t i = 0; i < count; ++i)
+                        {
+                            first[i] = static_cast<value_type>(random_below(gen, model.size()));
+                            second[i] = static_cast<value_type>(random_below(gen, model.size()));
+                        }
+
+                        std::vector<value_type> roots(count);
+                        std::vector<char> same(count);
+                        cuf.find_batch(first.begin(), first.end(), roots.begin());
+                        cuf.same_set_batch(first.begin(), first.end(), second.begin(), same.begin());
+                        for (size_t i = 0; i < count; ++i)
+                        {
+                            check(roots[i] == cuf.find(first[i]), "find_batch() differs from find()");
+                            check(static_cast<bool>(same[i]) == model.same_set(first[i], second[i]), "same_set_batch() result");
+                        }
+
+                        if (!inRange)
+                            check_out_of_range([&] { value_type v[2] = {a, b}; cuf.find_batch(v, v + 2, roots.begin()); }, "find_batch()");
+                    }
+                    break;
+
+                case 6:
+                    if constexpr (has_members<sets_type>::value)
+                    {
+                        if (v1 >= model.size())
+                        {
+                            check_out_of_range([&] { cuf.members(a); }, "members()");
+                            break;
+                        }
+                        auto members = cuf.members(a);
+                        check(!members.empty() && members.front() == a, "members() does not start with the value");
+                        std::sort(members.begin(), members.end());
+                        const auto expected = model.members(v1);
+                        check(std::equal(members.begin(), members.end(), expected.begin(), expected.end()), "members() differ");
+                    }
+                    break;
+
+                case 7:
+                    if constexpr (has_resize<sets_type>::value)
+                    {
+                        if (gen() % 4 == 0)
+                        {
+                            const size_t grown = model.size() + random_below(gen, 5);
+                            uf.resize(static_cast<typename sets_type::size_type>(grown));
+                            model.resize(grown);
+                        }
+                    }
+                    if constexpr (has_root_map<sets_type>::value)
+                    {
+                        if (gen() % 4 == 1 && v1 < model.size())
+                        {
+                            // the root map round trip keeps the partition
+                            const auto decoded = sets_type::from_root_map(cuf.root_map());
+                            check(static_cast<size_t>(decoded.size()) == model.size(), "from_root_map() size");
+                            for (size_t v = 0; v < model.size(); ++v)
+                            {
+                                const bool same = decoded.find(static_cast<value_type>(v)) == decoded.find(a);
+                                check(same == model.same_set(v, v1), "from_root_map() partition differs");
+                            }
+
+                            // a shard of a few joins, possibly larger, merged directly or as root map
+                            const size_t shardSize = model.size() + random_below(gen, 3);
+                            auto shard = sets_type::from_root_map(decoded.root_map());
+                            shard.resize(static_cast<typename sets_type::size_type>(shardSize));
+                            model.resize(shardSize);
+                            for (int join = 0; join < 2; ++join)
+                            {
+                                const size_t s1 = random_below(gen, shardSize);
+                                const size_t s2 = random_below(gen, shardSize);
+                                shard.join(static_cast<value_type>(s1), static_cast<value_type>(s2));
+                                model.join(s1, s2);
+                            }
+                            // derived classes link with their own join(), which check_sets() checks
+                            if (gen() % 2)
+                                uf.merge(shard);
+                            else
+                                uf.merge_root_map(shard.root_map());
+                        }
+                    }
+                    break;
+            }
+
+            check_sets(cuf, model, bySize);
+        });
+    }
+
+    /// run_sets() for weighted_union_find, every join has an offset and diff() is checked
+    template<typename sets_type>
+    void run_weighted(const std::string& name, sets_type& uf, size_t n, std::mt19937& gen, size_t steps)
+    {
+        using value_type = typename sets_type::value_type;
+        using join_result = typename sets_type::join_result;
+        naive_sets model(n);
+        const sets_type& cuf = uf;
+
+        run_steps(name, steps, [&]
+        {
+            const size_t v1 = random_below(gen, model.size() + 1);
+            const size_t v2 = random_below(gen, model.size() + 1);
+            const auto a = static_cast<value_type>(v1);
+            const auto b = static_cast<value_type>(v2);
+            const bool inRange = v1 < model.size() && v2 < model.size();
+            const long delta = static_cast<long>(random_below(gen, 21)) - 10;
+
+            switch (gen() % 4)
+            {
+                case 0: case 1:
+                    if (!inRange)
+                    {
+                        check_out_of_range([&] { uf.join(a, b, delta); }, "join()");
+                        break;
+                    }
+                    if (model.same_set(v1, v2))
+                    {
+                        const bool consistent = model.potential(v2) - model.potential(v1) == delta;
+                        check(uf.join(a, b, delta) == (consistent ? join_result::consistent : join_result::conflict),
+                                "join() of the same set");
+                    }
+                    else
+                    {
+                        check(uf.join(a, b, delta) == join_result::joined, "join() of different sets");
+                        model.join(v1, v2, delta);
+                    }
+                    break;
+
+                case 2:
+                    if (!inRange)
+                        check_out_of_range([&] { uf.diff(a, b); }, "diff()");
+                    else if (model.same_set(v1, v2))
+                        check(uf.diff(a, b) == model.potential(v2) - model.potential(v1), "diff() result");
+                    else
+                        check(!uf.same_set(a, b), "same_set() of different sets");
+                    break;
+
+                case 3:
+                    if (inRange && model.same_set(v1, v2))
+                        check(cuf.diff(a, b) == model.potential(v2) - model.potential(v1), "const diff() result");
+                    else if (inRange)
+                        check(cuf.find(a) != cuf.find(b), "const find() of different sets");
+                    break;
+            }
+
+            check_sets(cuf, model, true);
+        });
+    }
+
+    void fuzz_union_finds(std::mt19937& gen, size_t n, size_t steps)
+    {
+        {
+            checked_sets<union_find<unsigned>> uf(static_cast<unsigned>(n));
+            run_sets("union_find", uf, n, true, gen, steps);
+        }
+        {
+            checked_sets<union_find<unsigned, segmented_vector>> uf(static_cast<unsigned>(n));
+            run_sets("union_find<segmented_vector>", uf, n, true, gen, steps);
+        }
+        {
+            checked_sets<union_find<int>> uf(static_cast<int>(n));
+            run_sets("union_find<int>", uf, n, true, gen, steps);
+        }
+        {
+            compact_union_find<> uf(n);
+            run_sets("compact_union_find", uf, n, false, gen, steps);
+        }
+        {
+            const size_t count = std::min<size_t>(n, 64);
+            checked_sets<static_union_find<unsigned, 64>> uf(static_cast<unsigned>(count));
+            run_sets("static_union_find", uf, count, true, gen, steps);
+        }
+        {
+            checked_sets<enumerable_union_find<unsigned>> uf(static_cast<unsigned>(n));
+            run_sets("enumerable_union_find", uf, n, true, gen, steps);
+        }
+        {
+            checked_sets<hash_linked_union_find<unsigned>> uf(static_cast<unsigned>(n));
+            run_sets("hash_linked_union_find", uf, n, false, gen, steps);
+        }
+        {
+            std::vector<unsigned> newValue(n);
+            std::iota(newValue.begin(), newValue.end(), 0u);
+            std::shuffle(newValue.begin(), newValue.end(), gen);
+            relabeled_union_find<union_find<unsigned>> uf(newValue);
+            run_sets("relabeled_union_find", uf, n, true, gen, steps);
+        }
+        {
+            checked_sets<weighted_union_find<int, long>> uf(static_cast<int>(n));
+            run_weighted("weighted_union_find", uf, n, gen, steps);
+        }
+    }
+
+    /// stream_components() with tiny chunks, the read-ahead thread is what tsan looks at
+    void fuzz_streaming(std::mt19937& gen, size_t n)
+    {
+        const std::string path = "fuzz_containers.edges";
+        const size_t edgeCount = random_below(gen, 4 * n);
+        std::vector<unsigned> values(2 * edgeCount);
+        for (auto& value : values)
+            value = static_cast<unsigned>(random_below(gen, n));
+
+        {
+            std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::fopen(path.c_str(), "wb"), &std::fclose);
+            check(file && (values.empty() || std::fwrite(values.data(), sizeof(unsigned), values.size(), file.get()) == values.size()),
+                    "cannot write the edge file");
+        }
+
+        naive_sets model(n);
+        for (size_t i = 0; i < edgeCount; ++i)
+            model.join(values[2 * i], values[2 * i + 1]);
+
+        union_find<unsigned> uf(static_cast<unsigned>(n));
+        run_steps("stream_components", 1, [&]
+        {
+            stream_components(uf, path, 1 + random_below(gen, 16));
+            for (size_t i = 0; i < 4 * n; ++i)
+            {
+                const auto v1 = random_below(gen, n);
+                const auto v2 = random_below(gen, n);
+                check((uf.find(static_cast<unsigned>(v1)) == uf.find(static_cast<unsigned>(v2))) == model.same_set(v1, v2),
+                        "partition differs");
+            }
+            check(uf.count_disjoint() == model.count_disjoint(), "count_disjoint() differs");
+        });
+        std::remove(path.c_str());
+    }
+
+    void run_round(unsigned long seed)
+    {
+        std::mt19937 gen(static_cast<std::mt19937::result_type>(seed));
+
+        // mostly small sizes, where every step reaches the boundaries
+        const size_t sizeClass = gen() % 20;
+        const size_t n = 1 + random_below(gen, sizeClass < 10 ? 16 : sizeClass < 17 ? 64 : 1000);
+        const size_t steps = 300;
+
+        fuzz_queues(gen, n, steps);
+        fuzz_union_finds(gen, n, steps);
+        fuzz_streaming(gen, n);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const unsigned long seed = argc > 1 ? std::stoul(argv[1]) : 1;
+        const unsigned long rounds = argc > 2 ? std::stoul(argv[2]) : 200;
+
+        for (unsigned long round = 0; round < rounds; ++round)
+        {
+            try
+            {
+                run_round(seed + round);
+            }
+            catch (const std::exception& e)
+            {
+                std::fprintf(stderr, "fuzz_containers: seed %lu: %s\n", seed + round, e.what());
+                return 1;
+            }
+        }
+
+        std::printf("fuzz_containers: %lu rounds from seed %lu passed\n", rounds, seed);
+        return 0;
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "usage: fuzz_containers [seed [rounds]]: %s\n", e.what());
+        return 2;
+    }
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/// Hardware performance counters of the calling thread, read with perf_event_open(2).
+///
+/// Counting is opt-in: set BM_PERF_COUNTERS=1 in the environment. Events the kernel or the CPU does
+/// not support (or does not allow, see /proc/sys/kernel/perf_event_paranoid) are silently skipped,
+/// on other platforms nothing is counted.
+///
+/// The events are one group, so the PMU schedules them together and their ratios are exact. When
+/// the group still had to share the PMU, the counts are scaled up by enabled / running time and
+/// the fraction of time counted is reported as "perf-running".
+class perf_counters
+{
+    public:
+        perf_counters()
+        {
+            const char* enabled = std::getenv("BM_PERF_COUNTERS");
+            if (!enabled || std::string(enabled) == "0")
+                return;
+
+#ifdef __linux__
+            open_event("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+            open_event("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+            open_event("L1d-misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                    (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+            open_event("LLC-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+            open_event("branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+        }
+
+        ~perf_counters()
+        {
+#ifdef __linux__
+            for (const auto& event : mEvents)
+                close(event.fd);
+#endif
+        }
+
+        perf_counters(const perf_counters&) = delete;
+        perf_counters& operator= (const perf_counters&) = delete;
+
+        void start()
+        {
+#ifdef __linux__
+            if (!mEvents.empty())
+                ioctl(mEvents.front().fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+        }
+
+        void stop()
+        {
+#ifdef __linux__
+            if (!mEvents.empty())
+                ioctl(mEvents.front().fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+#endif
+        }
+
+        /// Reports the counts since construction divided by operations as user counters, e.g. "cycles/op"
+        void report(benchmark::State& state, double operations) const
+        {
+#ifdef __linux__
+            if (mEvents.empty() || operations <= 0)
+                return;
+
+            // PERF_FORMAT_GROUP layout: nr, time enabled, time running, nr values in opening order
+            std::vector<uint64_t> values(3 + mEvents.size());
+            const auto bytes = static_cast<ssize_t>(values.size() * sizeof(uint64_t));
+            if (read(mEvents.front().fd, values.data(), values.size() * sizeof(uint64_t)) != bytes ||
+                values[0] != mEvents.size())
+                return;
+
+            const uint64_t enabled = values[1];
+            const uint64_t running = values[2];
+            if (running < enabled)
+                state.counters["perf-running"] = enabled > 0 ? static_cast<double>(running) / enabled : 0.0;
+            if (running == 0)
+                return; // never scheduled, nothing to scale
+
+            const double scale = static_cast<double>(enabled) / static_cast<double>(running);
+            for (size_t i = 0; i < mEvents.size(); ++i)
+                state.counters[mEvents[i].name + "/op"] = static_cast<double>(values[3 + i]) * scale / operations;
+#else
+            (void) state;
+            (void) operations;
+#endif
+        }
+
+    private:
+
+#ifdef __linux__
+        void open_event(const char* name, uint32_t type, uint64_t config)
+        {
+            perf_event_attr attr {};
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                    PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            // the first event that opens leads the group, the others follow its enable and disable
+            const int leader = mEvents.empty() ? -1 : mEvents.front().fd;
+            attr.disabled = leader == -1;
+
+            const long fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+            if (fd >= 0)
+                mEvents.push_back({name, static_cast<int>(fd)});
+        }
+
+        struct event
+        {
+            std::string name;
+            int fd;
+        };
+
+        std::vector<event> mEvents;
+#endif
+};
+
+/// Counts the hardware events from construction to destruction, which should enclose only the
+/// measured loop of a benchmark, then reports them per operation:
+/// operationsPerIteration * state.iterations() operations in total.
+class perf_scope
+{
+    public:
+        perf_scope(benchmark::State& state, double operationsPerIteration)
+            : mState(state)
+            , mOperationsPerIteration(operationsPerIteration)
+        {
+            mCounters.start();
+        }
+
+        ~perf_scope()
+        {
+            mCounters.stop();
+            mCounters.report(mState, mOperationsPerIteration * static_cast<double>(mState.iterations()));
+        }
+
+    private:
+        benchmark::State& mState;
+        double mOperationsPerIteration;
+        perf_counters mCounters;
+};
@@ -0,0 +1,215 @@
+#include <bucket_queue.hpp>
+#include <indexed_heap.hpp>
+#include "testing.hpp"
+
+#include <random>
+
+namespace
+{
+    class test_queue
+        : public bucket_queue<unsigned short, int>
+    {
+        public:
+            using bucket_queue::bucket_queue;
+
+            /// Lower bound of the non-empty buckets
+            size_t min_bound() const
+            { return mMinBucket; }
+
+            bool check_lists() const
+            {
+                size_t queued = 0;
+                size_t minBucket = mBucketCount;
+
+                for (size_t bucket = 0; bucket < mBucketCount; ++bucket)
+                {
+                    const index_type head = sentinel(bucket);
+                    for (index_type node = mNext[head]; node != head; node = mNext[node])
+                    {
+                        if (node >= mItemCount || mPrev[mNext[node]] != node)
+                            return false;
+                        if (static_cast<size_t>(mPrio[node]) != bucket)
+                            return false;
+                        if (minBucket == mBucketCount)
+                            minBucket = bucket;
+                        ++queued;
+                    }
+                }
+
+                // mMinBucket is a lower bound, advanced lazily by top() and pop()
+                return queued == mSize && mMinBucket <= minBucket;
+            }
+    };
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(zero_sized_queue)
+{
+    test_queue q(0, 0);
+
+    BOOST_CHECK(q.empty());
+    BOOST_CHECK_EQUAL(q.size(), 0u);
+    BOOST_CHECK_NO_THROW(q.pop());
+    BOOST_CHECK_THROW(q.top(), std::out_of_range);
+    BOOST_CHECK_THROW(q.top_priority(), std::out_of_range);
+    BOOST_CHECK_THROW(q.push(0, 0), std::out_of_range);
+    BOOST_CHECK_THROW(q.get_priority(0), std::out_of_range);
+    BOOST_CHECK_THROW(q.change_priority(0, 0), std::out_of_range);
+    BOOST_CHECK(q.check_lists());
+
+    BOOST_CHECK_THROW(test_queue(60000, 6000), std::length_error);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(size_one_queue)
+{
+    test_queue q(1, 10);
+
+    BOOST_CHECK(q.empty());
+    BOOST_CHECK(!q.change_priority(0, 6));
+    BOOST_CHECK_THROW(q.top(), std::out_of_range);
+    BOOST_CHECK_THROW(q.get_priority(0), std::out_of_range);
+
+    // cannot push 1 (only 0), priorities must be in [0, 10)
+    BOOST_CHECK_THROW(q.push(1, 2), std::out_of_range);
+    BOOST_CHECK_THROW(q.push(0, 10), std::out_of_range);
+    BOOST_CHECK_THROW(q.push(0, -1), std::out_of_range);
+    BOOST_CHECK(q.empty());
+
+    BOOST_CHECK(q.push(0, 1));
+    BOOST_CHECK_EQUAL(q.size(), 1u);
+    BOOST_CHECK_EQUAL(q.top(), 0);
+    BOOST_CHECK_EQUAL(q.top_priority(), 1);
+    BOOST_CHECK_EQUAL(q.get_priority(0), 1);
+
+    // repeated push
+    BOOST_CHECK(!q.push(0, 3));
+    BOOST_CHECK_EQUAL(q.size(), 1u);
+    BOOST_CHECK_EQUAL(q.get_priority(0), 1);
+
+    // reset the priority
+    BOOST_CHECK(q.change_priority(0, 6));
+    BOOST_CHECK_THROW(q.change_priority(0, 10), std::out_of_range);
+    BOOST_CHECK_EQUAL(q.top(), 0);
+    BOOST_CHECK_EQUAL(q.top_priority(), 6);
+    BOOST_CHECK_EQUAL(q.get_priority(0), 6);
+    BOOST_CHECK(q.check_lists());
+
+    BOOST_CHECK_NO_THROW(q.pop());
+    BOOST_CHECK(q.empty());
+    BOOST_CHECK(q.check_lists());
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(push_pop_order)
+{
+    test_queue q(6, 20);
+
+    for (unsigned elem: {0,3,2,4,1})
+    {
+        BOOST_CHECK(q.push(elem, 10 + elem));
+        BOOST_CHECK(q.check_lists());
+    }
+
+    // equal priorities are popped in insertion order
+    BOOST_CHECK(q.push(5, 12));
+
+    for (unsigned elem: {0,1,2,5,3,4})
+    {
+        BOOST_CHECK_EQUAL(q.top(), elem);
+        BOOST_CHECK_NO_THROW(q.pop());
+        BOOST_CHECK(q.check_lists());
+    }
+
+    BOOST_CHECK(q.empty());
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(repriorize)
+{
+    test_queue q(5, 20);
+
+    for (unsigned elem: {0,3,2,4,1})
+        BOOST_CHECK(q.push(elem, 10 + elem));
+
+    for (unsigned elem: {0,3,2,4,1})
+    {
+        BOOST_CHECK(q.change_priority(elem, 10 - elem));
+        BOOST_CHECK(q.check_lists());
+    }
+
+    for (unsigned elem: {4,3,2,1,0})
+    {
+        BOOST_CHECK_EQUAL(q.top(), elem);
+        BOOST_CHECK_EQUAL(q.top_priority(), 10 - elem);
+        BOOST_CHECK_NO_THROW(q.pop());
+        BOOST_CHECK(q.check_lists());
+    }
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(same_as_indexed_heap)
+{
+    const unsigned short elems = 300;
+    test_queue q(elems, 50);
+    indexed_heap<unsigned short, int> reference(elems);
+
+    std::mt19937 gen(29);
+    std::uniform_int_distribution<unsigned short> elemDist(0, elems - 1);
+    std::uniform_int_distribution<int> prioDist(0, 49);
+
+    for (unsigned i = 0; i < 20000; ++i)
+    {
+        if (i % 5 == 0)
+        {
+            BOOST_REQUIRE_EQUAL(q.empty(), reference.empty());
+            if (!q.empty())
+            {
+                BOOST_REQUIRE_EQUAL(q.top_priority(), reference.top_priority());
+                BOOST_REQUIRE_EQUAL(reference.get_priority(q.top()), q.top_priority());
+                reference.change_priority(q.top(), -1);
+                reference.pop();
+                q.pop();
+            }
+        }
+        else
+        {
+            const auto elem = elemDist(gen);
+            const auto prio = prioDist(gen);
+            q.set_priority(elem, prio);
+            reference.set_priority(elem, prio);
+            BOOST_REQUIRE_EQUAL(q.get_priority(elem), reference.get_priority(elem));
+        }
+
+        BOOST_REQUIRE_EQUAL(q.size(), reference.size());
+    }
+
+    BOOST_CHECK(q.check_lists());
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(priority_changes_do_not_scan)
+{
+    // toggling the only element between the first and the last bucket leaves the lower bound, the
+    // scan happens once in top_priority()
+    test_queue q(1, 1000);
+    q.push(0, 0);
+    for (int round = 0; round < 100; ++round)
+    {
+        q.change_priority(0, 999);
+        BOOST_REQUIRE_EQUAL(q.min_bound(), 0u);
+        q.change_priority(0, 0);
+        BOOST_REQUIRE(q.check_lists());
+    }
+
+    q.change_priority(0, 999);
+    BOOST_CHECK_EQUAL(q.top_priority(), 999);
+    BOOST_CHECK_EQUAL(q.min_bound(), 999u);
+    BOOST_CHECK_EQUAL(q.top(), 0u);
+
+    q.pop();
+    BOOST_CHECK(q.empty());
+    q.push(0, 5); // below the bound, lowers it
+    BOOST_CHECK_EQUAL(q.min_bound(), 5u);
+    BOOST_CHECK(q.check_lists());
+}
@@ -0,0 +1,158 @@
+#include <compact_union_find.hpp>
+#include <union_find.hpp>
+#include "testing.hpp"
+
+#include <random>
+
+using compact = compact_union_find<>;
+
+// =================================================================================================
+BOOST_AUTO_TEST_SUITE(interface_test)
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(zero_sized)
+{
+    compact uf(0);
+
+    BOOST_CHECK_EQUAL(uf.size(), 0u);
+    BOOST_CHECK_EQUAL(uf.count_disjoint(), 0u);
+    BOOST_CHECK_EQUAL(uf.count_singleton(), 0u);
+    BOOST_CHECK_THROW(uf.find(0), std::out_of_range);
+    BOOST_CHECK_THROW(uf.find(1), std::out_of_range);
+    BOOST_CHECK_THROW(uf.join(0, 1), std::out_of_range);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(size_two)
+{
+    compact uf(2);
+
+    BOOST_CHECK_EQUAL(uf.find_opt(0), 0u);
+    BOOST_CHECK_EQUAL(uf.find_opt(1), 1u);
+    BOOST_CHECK_THROW(uf.find_opt(2), std::out_of_range);
+
+    BOOST_CHECK(!uf.join(0, 0));
+    BOOST_CHECK(uf.join(0, 1));
+    BOOST_CHECK(!uf.join(0, 1));
+
+    BOOST_CHECK_EQUAL(uf.find_opt(0), uf.find_opt(1));
+    BOOST_CHECK_EQUAL(uf.count_disjoint(), 1u);
+    BOOST_CHECK_EQUAL(uf.count_singleton(), 0u);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(count_disjoint_and_singleton)
+{
+    compact uf(32);
+
+    BOOST_CHECK_EQUAL(uf.count_disjoint(), uf.size());
+    BOOST_CHECK_EQUAL(uf.count_singleton(), uf.size());
+
+    for (unsigned i = 0; i < 32 - 8; ++i)
+    {
+        BOOST_CHECK_EQUAL(uf.count_disjoint(), uf.size() - i);
+        BOOST_CHECK_EQUAL(uf.count_singleton(), uf.size() - i - (i <= 8 ? i : 8));
+        BOOST_CHECK(uf.join(i, i + 8));
+    }
+
+    BOOST_CHECK_EQUAL(uf.count_disjoint(), 8u);
+    BOOST_CHECK_EQUAL(uf.count_singleton(), 0u);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(resize)
+{
+    compact uf(8);
+    BOOST_CHECK(uf.join(0, 7));
+
+    BOOST_CHECK_THROW(uf.resize(7), std::out_of_range);
+    BOOST_CHECK_THROW(uf.resize(compact::maxSize + 1), std::length_error);
+    BOOST_CHECK_THROW(compact_union_find<16>(compact_union_find<16>::maxSize + 1), std::length_error);
+
+    BOOST_CHECK_NO_THROW(uf.resize(3 * compact::chunkSize + 11));
+    BOOST_CHECK_EQUAL(uf.size(), 3 * compact::chunkSize + 11);
+    BOOST_CHECK_EQUAL(uf.find(0), uf.find(7));
+    BOOST_CHECK_EQUAL(uf.count_disjoint(), uf.size() - 1);
+    BOOST_CHECK_EQUAL(uf.count_singleton(), uf.size() - 2);
+
+    BOOST_CHECK(uf.join(7, uf.max_value()));
+    BOOST_CHECK_EQUAL(uf.find(0), uf.find(uf.max_value()));
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_SUITE_END()
+
+// =================================================================================================
+BOOST_AUTO_TEST_SUITE(storage)
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(lazy_chunks)
+{
+    const uint64_t n = uint64_t(1) << 34; // only chunk pointers are allocated
+    compact uf(n);
+
+    BOOST_CHECK_EQUAL(uf.allocated_chunks(), 0u);
+    BOOST_CHECK_EQUAL(uf.count_singleton(), n);
+    BOOST_CHECK_EQUAL(uf.find(n - 1), n - 1);
+    BOOST_CHECK_EQUAL(uf.allocated_chunks(), 0u);
+
+    // both ends are in the same chunk
+    BOOST_CHECK(uf.join(1, 2));
+    BOOST_CHECK_EQUAL(uf.allocated_chunks(), 1u);
+
+    // joining in an untouched chunk allocates it
+    BOOST_CHECK(uf.join(1, n - 1));
+    BOOST_CHECK_EQUAL(uf.allocated_chunks(), 2u);
+    BOOST_CHECK_EQUAL(uf.find(n - 1), uf.find(2));
+    BOOST_CHECK_EQUAL(uf.count_disjoint(), n - 2);
+    BOOST_CHECK_EQUAL(uf.count_singleton(), n - 3);
+
+    BOOST_CHECK_LT(uf.memory_usage(), 2 * (n / compact::chunkSize) * sizeof(void*) + 2 * 6 * compact::chunkSize);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(large_values)
+{
+    const uint64_t n = uint64_t(1) << 36;
+    compact uf(n);
+
+    const uint64_t a = n - 1;
+    const uint64_t b = uint64_t(1) << 35;
+    const uint64_t c = uint64_t(1) << 32;
+
+    BOOST_CHECK(uf.join(a, b));
+    BOOST_CHECK(uf.join(c, b));
+    BOOST_CHECK_EQUAL(uf.find(a), uf.find(c));
+    BOOST_CHECK(uf.find(a) == a || uf.find(a) == b);
+    BOOST_CHECK_EQUAL(uf.find_opt(c), uf.find(b));
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(same_as_union_find)
+{
+    const unsigned n = 3 * compact::chunkSize / 2;
+    compact uf(n);
+    union_find<unsigned> reference(n);
+
+    std::mt19937 gen(26);
+    std::uniform_int_distribution<unsigned> dist(0, n - 1);
+
+    for (unsigned i = 0; i < n / 2; ++i)
+    {
+        const auto v1 = dist(gen);
+        const auto v2 = dist(gen);
+        BOOST_REQUIRE_EQUAL(uf.join(v1, v2), reference.join(v1, v2));
+    }
+
+    BOOST_CHECK_EQUAL(uf.count_disjoint(), reference.count_disjoint());
+    BOOST_CHECK_EQUAL(uf.count_singleton(), reference.count_singleton());
+
+    for (unsigned i = 0; i < n; ++i)
+    {
+        const auto v = dist(gen);
+        BOOST_REQUIRE_EQUAL(uf.find(i) == uf.find(v), reference.find(i) == reference.find(v));
+    }
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,224 @@
+#include <deadline_scheduler.hpp>
+#include "testing.hpp"
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    using scheduler = deadline_scheduler<unsigned short, long>;
+
+    /// Appends the id of every fired timer to a log
+    auto logging(std::vector<unsigned short>& log)
+    {
+        return [&log](unsigned short id) { log.push_back(id); };
+    }
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(zero_timers)
+{
+    scheduler s(0);
+
+    BOOST_CHECK(s.empty());
+    BOOST_CHECK_EQUAL(s.run_until(100), 0u);
+    BOOST_CHECK_THROW(s.schedule(0, 1, [](unsigned short) {}), std::out_of_range);
+    BOOST_CHECK_THROW(s.reschedule(0, 1), std::out_of_range);
+    BOOST_CHECK_THROW(s.cancel(0), std::out_of_range);
+    BOOST_CHECK_THROW(s.next_deadline(), std::out_of_range);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(fire_in_deadline_order)
+{
+    std::vector<unsigned short> log;
+    scheduler s(6);
+
+    for (unsigned short id : {3, 0, 5, 1})
+        s.schedule(id, 10 * id, logging(log));
+
+    BOOST_CHECK_EQUAL(s.size(), 4u);
+    BOOST_CHECK_EQUAL(s.next_deadline(), 0);
+    BOOST_CHECK_THROW(s.schedule(2, 5), std::invalid_argument); // never had a callback
+
+    BOOST_CHECK_EQUAL(s.run_until(10), 2u);
+    BOOST_CHECK((log == std::vector<unsigned short>{0, 1}));
+    BOOST_CHECK(!s.armed(1));
+    BOOST_CHECK(s.armed(3));
+    BOOST_CHECK_EQUAL(s.deadline(3), 30);
+
+    // re-arm, reschedule and cancel
+    BOOST_CHECK(s.reschedule(5, 15));
+    BOOST_CHECK(!s.reschedule(1, 20));
+    s.schedule(1, 20); // keeps the callback
+    BOOST_CHECK(s.cancel(3));
+    BOOST_CHECK(!s.cancel(3));
+    BOOST_CHECK_EQUAL(s.size(), 2u);
+
+    log.clear();
+    BOOST_CHECK_EQUAL(s.run_until(100), 2u);
+    BOOST_CHECK((log == std::vector<unsigned short>{5, 1}));
+    BOOST_CHECK(s.empty());
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(callbacks_change_the_batch)
+{
+    std::vector<unsigned short> log;
+    scheduler s(8);
+
+    s.schedule(0, 1, [&](unsigned short id)
+    {
+        log.push_back(id);
+        BOOST_CHECK(s.cancel(1)); // due, does not fire
+        BOOST_CHECK(s.reschedule(2, 50)); // due, moves out of the batch
+        s.schedule(0, 3); // itself, fires in the next run
+        s.schedule(4, 0, logging(log)); // past, next run
+        BOOST_CHECK_EQUAL(s.next_deadline(), 0);
+        BOOST_CHECK_THROW(s.run_until(5), std::logic_error);
+    });
+    s.schedule(1, 2, logging(log));
+    s.schedule(2, 3, logging(log));
+    s.schedule(3, 4, logging(log));
+
+    BOOST_CHECK_EQUAL(s.run_until(5), 2u);
+    BOOST_CHECK((log == std::vector<unsigned short>{0, 3}));
+    BOOST_CHECK(!s.armed(1));
+    BOOST_CHECK_EQUAL(s.deadline(2), 50);
+    BOOST_CHECK_EQUAL(s.size(), 3u);
+
+    log.clear();
+    s.schedule(0, 5, logging(log)); // replaces the callback
+    BOOST_CHECK_EQUAL(s.run_until(5), 2u);
+    BOOST_CHECK((log == std::vector<unsigned short>{4, 0}));
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(throwing_callback)
+{
+    std::vector<unsigned short> log;
+    scheduler s(4);
+
+    s.schedule(0, 1, logging(log));
+    s.schedule(1, 2, [](unsigned short) { throw std::runtime_error("timer"); });
+    s.schedule(2, 3, logging(log));
+    s.schedule(3, 30, logging(log));
+
+    BOOST_CHECK_THROW(s.run_until(10), std::runtime_error);
+    BOOST_CHECK((log == std::vector<unsigned short>{0}));
+    BOOST_CHECK(!s.armed(1));
+    BOOST_CHECK_EQUAL(s.deadline(2), 3);
+    BOOST_CHECK_EQUAL(s.size(), 2u);
+
+    BOOST_CHECK_EQUAL(s.run_until(100), 2u);
+    BOOST_CHECK((log == std::vector<unsigned short>{0, 2, 3}));
+
+    s.schedule(1, 5); // the throwing callback is kept too
+    BOOST_CHECK_THROW(s.run_until(100), std::runtime_error);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(random_rearms)
+{
+    const unsigned short n = 500;
+    std::vector<long> expected(n, -1); // deadline by id, -1 if not armed
+    std::vector<long> firedAt(n, -1);
+    long now = 0;
+
+    scheduler s(n);
+    std::mt19937 gen(41);
+    std::uniform_int_distribution<unsigned short> ids(0, n - 1);
+    std::uniform_int_distribution<long> delays(0, 100);
+
+    for (unsigned round = 0; round < 2000; ++round)
+    {
+        const auto id = ids(gen);
+        const long when = now + delays(gen);
+        switch (gen() % 4)
+        {
+            case 0:
+                BOOST_REQUIRE_EQUAL(s.cancel(id), expected[id] >= 0);
+                expected[id] = -1;
+                break;
+            case 1:
+                BOOST_REQUIRE_EQUAL(s.reschedule(id, when), expected[id] >= 0);
+                if (expected[id] >= 0)
+                    expected[id] = when;
+                break;
+            default:
+                s.schedule(id, when, [&, id](unsigned short fired)
+                {
+                    BOOST_REQUIRE_EQUAL(fired, id);
+                    firedAt[fired] = now;
+                });
+                expected[id] = when;
+                break;
+        }
+
+        if (round % 10 == 0)
+        {
+            now += 7;
+            s.run_until(now);
+            for (unsigned short id = 0; id < n; ++id)
+            {
+                if (expected[id] >= 0 && expected[id] <= now)
+                {
+                    BOOST_REQUIRE_EQUAL(firedAt[id], now);
+                    expected[id] = -1;
+                }
+                BOOST_REQUIRE_EQUAL(s.armed(id), expected[id] >= 0);
+            }
+        }
+    }
+}
+
+#ifdef DEADLINE_SCHEDULER_COROUTINES
+// =================================================================================================
+namespace
+{
+    /// Minimal eagerly started coroutine without a result
+    struct task
+    {
+        struct promise_type
+        {
+            task get_return_object() { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    task sleeper(scheduler& s, unsigned short id, long period, std::vector<long>& wakeups, const long& now)
+    {
+        for (long when = period; when <= 3 * period; when += period)
+        {
+            co_await s.sleep_until(id, when);
+            wakeups.push_back(now);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sleep_until)
+{
+    scheduler s(2);
+    std::vector<long> fast, slow;
+    long now = 0;
+
+    sleeper(s, 0, 10, fast, now);
+    sleeper(s, 1, 25, slow, now);
+    BOOST_CHECK_EQUAL(s.size(), 2u);
+
+    for (now = 5; now <= 100; now += 5)
+        s.run_until(now);
+
+    BOOST_CHECK((fast == std::vector<long>{10, 20, 30}));
+    BOOST_CHECK((slow == std::vector<long>{25, 50, 75}));
+    BOOST_CHECK(s.empty());
+
+    // the finished coroutines left no callbacks behind
+    BOOST_CHECK_THROW(s.schedule(0, 200), std::invalid_argument);
+    BOOST_CHECK_THROW(s.schedule(1, 200), std::invalid_argument);
+}
+#endif
@@ -0,0 +1,92 @@
+#include <enumerable_union_find.hpp>
+#include <segmented_vector.hpp>
+#include "testing.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+    template<typename union_find_type>
+    std::vector<unsigned> sorted_members(const union_find_type& uf, unsigned value)
+    {
+        auto members = uf.members(value);
+        std::sort(members.begin(), members.end());
+        return members;
+    }
+
+    /// Members by scanning find() over all elements
+    template<typename union_find_type>
+    std::vector<unsigned> scanned_members(const union_find_type& uf, unsigned value)
+    {
+        std::vector<unsigned> members;
+        for (unsigned v = 0; v < uf.size(); ++v)
+        {
+            if (uf.find(v) == uf.find(value))
+                members.push_back(v);
+        }
+        return members;
+    }
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(singletons)
+{
+    enumerable_union_find<unsigned> uf(3);
+
+    BOOST_CHECK_THROW(uf.members(3), std::out_of_range);
+    for (unsigned v = 0; v < 3; ++v)
+        BOOST_CHECK(uf.members(v) == std::vector<unsigned>{v});
+
+    enumerable_union_find<unsigned> empty(0);
+    BOOST_CHECK_THROW(empty.members(0), std::out_of_range);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(join_splices)
+{
+    enumerable_union_find<unsigned> uf(6);
+
+    BOOST_CHECK(uf.join(0, 1));
+    BOOST_CHECK(uf.join(2, 3));
+    BOOST_CHECK(!uf.join(1, 0));
+    BOOST_CHECK(sorted_members(uf, 1) == (std::vector<unsigned>{0, 1}));
+
+    BOOST_CHECK(uf.join(3, 1));
+    BOOST_CHECK(sorted_members(uf, 2) == (std::vector<unsigned>{0, 1, 2, 3}));
+    BOOST_CHECK(uf.members(4) == std::vector<unsigned>{4});
+
+    // enumeration starts at the given value
+    BOOST_CHECK_EQUAL(uf.members(3).front(), 3u);
+
+    unsigned count = 0;
+    uf.for_each_member(0, [&count](unsigned) { ++count; });
+    BOOST_CHECK_EQUAL(count, 4u);
+
+    uf.resize(8);
+    BOOST_CHECK(uf.members(7) == std::vector<unsigned>{7});
+    BOOST_CHECK(uf.join(7, 0));
+    BOOST_CHECK(sorted_members(uf, 5) == std::vector<unsigned>{5});
+    BOOST_CHECK(sorted_members(uf, 7) == (std::vector<unsigned>{0, 1, 2, 3, 7}));
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(same_as_find_scan)
+{
+    const unsigned n = 3000;
+    enumerable_union_find<unsigned, segmented_vector> uf(n);
+
+    std::mt19937 gen(34);
+    std::uniform_int_distribution<unsigned> dist(0, n - 1);
+
+    for (unsigned i = 0; i < n; ++i)
+    {
+        uf.join(dist(gen), dist(gen));
+        if (i % 100 == 0)
+        {
+            const auto value = dist(gen);
+            BOOST_REQUIRE(sorted_members(uf, value) == scanned_members(uf, value));
+        }
+    }
+}
@@ -1,6 +1,13 @@
 #include <indexed_heap.hpp>
+#include <segmented_vector.hpp>
 #include "testing.hpp"
 
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <type_traits>
+
 namespace
 {
     class test_heap
@@ -163,3 +170,191 @@ BOOST_AUTO_TEST_CASE(heap_property_repriorize)
 
     BOOST_CHECK_EQUAL(q.size(), 0);
 }
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(move_only_payload)
+{
+    indexed_heap<unsigned, int, std::unique_ptr<int>> q(5);
+
+    BOOST_CHECK_THROW(q.value(0), std::out_of_range);
+    BOOST_CHECK_THROW(q.value(5), std::out_of_range);
+
+    for (unsigned elem: {0,3,2,4,1})
+        BOOST_CHECK(q.push(elem, 10 - elem, std::make_unique<int>(100 + elem)));
+
+    // repeated push keeps the original value
+    BOOST_CHECK(!q.push(2, 1, std::make_unique<int>(0)));
+    BOOST_CHECK_EQUAL(*q.value(2), 102);
+
+    // repriorizing does not touch the values
+    BOOST_CHECK(q.change_priority(0, 0));
+    *q.value(3) = 7;
+
+    BOOST_CHECK_EQUAL(q.top(), 0u);
+    BOOST_CHECK_EQUAL(*q.pop_with_value(), 100);
+    BOOST_CHECK_THROW(q.value(0), std::out_of_range);
+
+    for (unsigned elem: {4,3,2,1})
+    {
+        BOOST_CHECK_EQUAL(q.top(), elem);
+        auto value = q.pop_with_value();
+        BOOST_REQUIRE(value);
+        BOOST_CHECK_EQUAL(*value, elem == 3 ? 7 : 100 + int(elem));
+    }
+
+    BOOST_CHECK(q.empty());
+    BOOST_CHECK_THROW(q.pop_with_value(), std::out_of_range);
+
+    // plain pop releases the value, a pushed element without value gets an empty one
+    BOOST_CHECK(q.push(1, 5, std::make_unique<int>(1)));
+    q.pop();
+    BOOST_CHECK(q.push(1, 5));
+    BOOST_CHECK(!q.value(1));
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(reserve_elements)
+{
+    test_heap q(2);
+
+    BOOST_CHECK_EQUAL(q.element_count(), 2u);
+    BOOST_CHECK(q.push(1, 5));
+    BOOST_CHECK_THROW(q.push(2, 3), std::out_of_range);
+
+    q.reserve_elements(1);
+    BOOST_CHECK_EQUAL(q.element_count(), 2u);
+
+    q.reserve_elements(10);
+    BOOST_CHECK_EQUAL(q.element_count(), 10u);
+    BOOST_CHECK_EQUAL(q.top(), 1);
+    BOOST_CHECK(q.push(9, 3));
+    BOOST_CHECK(q.push(2, 4));
+    BOOST_CHECK_EQUAL(q.top(), 9);
+    BOOST_CHECK(q.check_heap());
+    BOOST_CHECK(q.check_index());
+
+    BOOST_CHECK_THROW(q.reserve_elements(70000), std::length_error);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(segmented_storage)
+{
+    indexed_heap<unsigned, int, std::unique_ptr<int>, segmented_vector> q;
+
+    for (unsigned n = 1000; n <= 200000; n *= 4)
+    {
+        q.reserve_elements(n);
+        for (unsigned elem = n / 4; elem < n; ++elem)
+            BOOST_REQUIRE(q.push(elem, -int(elem % 1000), std::make_unique<int>(elem)));
+    }
+
+    BOOST_CHECK_EQUAL(q.element_count(), 64000u);
+    BOOST_CHECK_EQUAL(q.size(), 64000u - 250u);
+    int lastPrio = -1000;
+    for (unsigned i = 0; i < 1000; ++i)
+    {
+        const auto elem = q.top();
+        BOOST_CHECK_LE(lastPrio, q.top_priority());
+        BOOST_CHECK_EQUAL(q.top_priority(), -int(elem % 1000));
+        lastPrio = q.top_priority();
+        BOOST_CHECK_EQUAL(*q.pop_with_value(), int(elem));
+    }
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(erase)
+{
+    test_heap q(200);
+    std::mt19937 gen(41);
+    std::uniform_int_distribution<int> prios(-50, 50);
+
+    for (unsigned short elem = 0; elem < 200; ++elem)
+        q.push(elem, prios(gen));
+
+    BOOST_CHECK_THROW(q.erase(200), std::out_of_range);
+
+    // from the middle, the root and the last position, moving the last up or down
+    for (unsigned short elem = 0; elem < 200; elem += 2)
+    {
+        BOOST_REQUIRE(q.erase(elem));
+        BOOST_REQUIRE(!q.erase(elem));
+        BOOST_REQUIRE(q.check_heap());
+        BOOST_REQUIRE(q.check_index());
+    }
+    BOOST_CHECK(q.erase(q.top()));
+    BOOST_CHECK_EQUAL(q.size(), 99u);
+
+    int last = std::numeric_limits<int>::min();
+    while (!q.empty())
+    {
+        BOOST_REQUIRE_EQUAL(q.top() % 2, 1);
+        BOOST_REQUIRE_LE(last, q.top_priority());
+        last = q.top_priority();
+        q.pop();
+    }
+
+    BOOST_CHECK(q.push(4, 1));
+    BOOST_CHECK(q.erase(4));
+    BOOST_CHECK(q.empty());
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(narrow_elem_type)
+{
+    // 2 * index + 1 of the deepest parents exceeds unsigned char
+    indexed_heap<unsigned char, int> q(255);
+
+    for (unsigned elem = 0; elem < 255; ++elem)
+        BOOST_REQUIRE(q.push(static_cast<unsigned char>(elem), int((elem * 37) % 255)));
+
+    for (int prio = 0; prio < 255; ++prio)
+    {
+        BOOST_REQUIRE_EQUAL(q.top_priority(), prio);
+        q.pop();
+    }
+    BOOST_CHECK(q.empty());
+}
+
+// =================================================================================================
+namespace
+{
+    template<typename heap_type>
+    class item_size
+        : public heap_type
+    {
+        public:
+            static constexpr size_t value = sizeof(typename heap_type::item_type);
+    };
+}
+
+BOOST_AUTO_TEST_CASE(narrow_index_type)
+{
+    using narrow_heap = indexed_heap<uint64_t, uint32_t, void, std::vector, uint16_t>;
+
+    static_assert(std::is_same<narrow_heap::index_type, uint16_t>::value, "index_type parameter");
+    static_assert(item_size<narrow_heap>::value < item_size<indexed_heap<uint64_t, uint32_t>>::value,
+            "elements are stored as index_type");
+    static_assert(std::is_same<indexed_heap_index_t<254>, uint8_t>::value, "");
+    static_assert(std::is_same<indexed_heap_index_t<255>, uint16_t>::value, "");
+    static_assert(std::is_same<indexed_heap_index_t<100000000>, uint32_t>::value, "");
+    static_assert(std::is_same<indexed_heap_index_t<uint64_t(1) << 32>, uint64_t>::value, "");
+
+    BOOST_CHECK_THROW(narrow_heap(65536), std::length_error);
+
+    narrow_heap q(60000);
+    for (uint64_t elem = 0; elem < 60000; ++elem)
+        BOOST_REQUIRE(q.push(elem, uint32_t((elem * 7919) % 60000)));
+    BOOST_CHECK_THROW(q.push(60000, 1), std::out_of_range);
+    BOOST_CHECK_THROW(q.reserve_elements(65536), std::length_error);
+
+    BOOST_CHECK(q.change_priority(59999, 0));
+    BOOST_CHECK_EQUAL(q.get_priority(59999), 0u);
+    uint32_t last = 0;
+    while (!q.empty())
+    {
+        BOOST_REQUIRE_LE(last, q.top_priority());
+        last = q.top_priority();
+        BOOST_REQUIRE_LT(q.top(), 60000u);
+        q.pop();
+    }
+}
@@ -0,0 +1,165 @@
+#include <kruskal_tree.hpp>
+#include "testing.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using tree = kruskal_tree<unsigned short, int>;
+    using query = std::pair<unsigned short, unsigned short>;
+
+    const int noPath = -1;
+
+    /// Smallest possible largest edge weight over all paths, Floyd-Warshall on (min, max)
+    std::vector<std::vector<int>> minimax_paths(size_t n, const std::vector<std::tuple<int, unsigned short, unsigned short>>& edges)
+    {
+        const int inf = 1 << 30;
+        std::vector<std::vector<int>> d(n, std::vector<int>(n, inf));
+        for (const auto& edge : edges)
+        {
+            auto& w = d[std::get<1>(edge)][std::get<2>(edge)];
+            w = std::min(w, std::get<0>(edge));
+            d[std::get<2>(edge)][std::get<1>(edge)] = w;
+        }
+
+        for (size_t k = 0; k < n; ++k)
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = 0; j < n; ++j)
+                    d[i][j] = std::min(d[i][j], std::max(d[i][k], d[k][j]));
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            for (size_t j = 0; j < n; ++j)
+            {
+                if (i == j || d[i][j] == inf)
+                    d[i][j] = noPath;
+            }
+        }
+        return d;
+    }
+
+    bool is_ancestor(const tree& t, tree::node_type ancestor, tree::node_type node)
+    {
+        for (; node != tree::noNode; node = t.tree_parent(node))
+        {
+            if (node == ancestor)
+                return true;
+        }
+        return false;
+    }
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(empty_and_single)
+{
+    tree empty(0);
+    std::vector<query> none;
+    std::vector<int> result;
+    BOOST_CHECK_EQUAL(empty.node_count(), 0u);
+    empty.bottleneck_batch(none.begin(), none.end(), std::back_inserter(result), noPath);
+    BOOST_CHECK(result.empty());
+
+    tree single(1);
+    std::vector<query> self{{0, 0}};
+    single.bottleneck_batch(self.begin(), self.end(), std::back_inserter(result), noPath);
+    BOOST_CHECK((result == std::vector<int>{noPath}));
+    BOOST_CHECK_THROW(single.join(0, 1, 5), std::out_of_range);
+    BOOST_CHECK_THROW(single.weight(0), std::out_of_range);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(reconstruction_tree)
+{
+    tree t(5);
+
+    BOOST_CHECK(t.join(0, 1, 1));
+    BOOST_CHECK(t.join(2, 3, 2));
+    BOOST_CHECK(!t.join(1, 0, 3));
+    BOOST_CHECK(t.join(1, 3, 4));
+    BOOST_CHECK_THROW(t.join(3, 4, 3), std::invalid_argument);
+    BOOST_CHECK_EQUAL(t.node_count(), 8u);
+    BOOST_CHECK_EQUAL(t.count_disjoint(), 2u);
+
+    // internal nodes 5: {0,1}, 6: {2,3}, 7: {5,6}
+    BOOST_CHECK_EQUAL(t.tree_parent(0), 5u);
+    BOOST_CHECK_EQUAL(t.tree_parent(3), 6u);
+    BOOST_CHECK_EQUAL(t.tree_parent(5), 7u);
+    BOOST_CHECK_EQUAL(t.tree_parent(6), 7u);
+    BOOST_CHECK_EQUAL(t.tree_parent(7), tree::noNode);
+    BOOST_CHECK_EQUAL(t.tree_parent(4), tree::noNode);
+    BOOST_CHECK_EQUAL(t.weight(7), 4);
+    BOOST_CHECK_THROW(t.tree_parent(8), std::out_of_range);
+
+    std::vector<query> queries{{0, 1}, {1, 2}, {3, 2}, {0, 4}, {4, 4}, {0, 3}};
+    std::vector<tree::node_type> lcas;
+    t.lca_batch(queries.begin(), queries.end(), std::back_inserter(lcas));
+    BOOST_CHECK((lcas == std::vector<tree::node_type>{5, 7, 6, tree::noNode, 4, 7}));
+
+    std::vector<int> bottlenecks;
+    t.bottleneck_batch(queries.begin(), queries.end(), std::back_inserter(bottlenecks), noPath);
+    BOOST_CHECK((bottlenecks == std::vector<int>{1, 4, 2, noPath, noPath, 4}));
+
+    std::vector<query> outOfRange{{0, 5}};
+    BOOST_CHECK_THROW(t.lca_batch(outOfRange.begin(), outOfRange.end(), std::back_inserter(lcas)), std::out_of_range);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(same_as_minimax_paths)
+{
+    std::mt19937 gen(42);
+
+    for (unsigned round = 0; round < 50; ++round)
+    {
+        const unsigned short n = 1 + gen() % 40;
+        const size_t edgeCount = gen() % (2 * n);
+        std::uniform_int_distribution<unsigned short> values(0, n - 1);
+        std::uniform_int_distribution<int> weights(0, 20);
+
+        std::vector<std::tuple<int, unsigned short, unsigned short>> edges;
+        for (size_t e = 0; e < edgeCount; ++e)
+            edges.emplace_back(weights(gen), values(gen), values(gen));
+        std::sort(edges.begin(), edges.end());
+
+        tree t(n);
+        for (const auto& edge : edges)
+            t.join(std::get<1>(edge), std::get<2>(edge), std::get<0>(edge));
+
+        std::vector<query> queries;
+        for (unsigned short a = 0; a < n; ++a)
+            for (unsigned short b = 0; b < n; ++b)
+                queries.emplace_back(a, b);
+        std::shuffle(queries.begin(), queries.end(), gen);
+
+        std::vector<tree::node_type> lcas;
+        std::vector<int> bottlenecks;
+        t.lca_batch(queries.begin(), queries.end(), std::back_inserter(lcas));
+        t.bottleneck_batch(queries.begin(), queries.end(), std::back_inserter(bottlenecks), noPath);
+
+        const auto expected = minimax_paths(n, edges);
+        for (size_t q = 0; q < queries.size(); ++q)
+        {
+            const auto a = queries[q].first;
+            const auto b = queries[q].second;
+            BOOST_REQUIRE_EQUAL(bottlenecks[q], expected[a][b]);
+            if (lcas[q] == tree::noNode)
+            {
+                BOOST_REQUIRE(t.find(a) != t.find(b));
+                continue;
+            }
+
+            // the lowest common ancestor: above both, but none of its children is
+            BOOST_REQUIRE(is_ancestor(t, lcas[q], a));
+            BOOST_REQUIRE(is_ancestor(t, lcas[q], b));
+            for (tree::node_type child = 0; child < t.node_count(); ++child)
+            {
+                if (t.tree_parent(child) == lcas[q])
+                    BOOST_REQUIRE(!(is_ancestor(t, child, a) && is_ancestor(t, child, b)));
+            }
+        }
+    }
+}
@@ -0,0 +1,201 @@
+#include <indexed_heap.hpp>
+#include <lazy_indexed_heap.hpp>
+#include <segmented_vector.hpp>
+#include "testing.hpp"
+
+#include <limits>
+#include <random>
+
+namespace
+{
+    template<template<typename...> class container = std::vector>
+    class test_heap
+        : public lazy_indexed_heap<unsigned short, int, container>
+    {
+        public:
+            using lazy_indexed_heap<unsigned short, int, container>::lazy_indexed_heap;
+
+            /// The heap holds the priorities before the pending updates, it stays ordered
+            bool check_heap() const
+            {
+                for (size_t i = 1; i < this->mHeap.size(); ++i)
+                {
+                    if (this->mHeap[i].prio < this->mHeap[(i - 1) / 2].prio)
+                        return false;
+                    if (this->mIndex[this->mHeap[i].elem] != i)
+                        return false;
+                }
+                return true;
+            }
+
+            bool check_dirty() const
+            {
+                size_t pushes = 0;
+                for (auto elem : this->mDirtyElems)
+                {
+                    if (!this->mDirty[elem])
+                        return false;
+                    if (this->mIndex[elem] == this->invalidIndex)
+                        ++pushes;
+                }
+
+                size_t dirty = 0;
+                for (size_t elem = 0; elem < this->element_count(); ++elem)
+                {
+                    if (this->mDirty[elem])
+                        ++dirty;
+                }
+
+                return dirty == this->mDirtyElems.size() && pushes == this->mPendingPushes;
+            }
+    };
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(zero_sized_heap)
+{
+    test_heap<> q(0);
+
+    BOOST_CHECK(q.empty());
+    BOOST_CHECK_EQUAL(q.size(), 0u);
+    BOOST_CHECK_NO_THROW(q.pop());
+    BOOST_CHECK_THROW(q.top(), std::out_of_range);
+    BOOST_CHECK_THROW(q.top_priority(), std::out_of_range);
+    BOOST_CHECK_THROW(q.push(0, 0), std::out_of_range);
+    BOOST_CHECK_THROW(q.get_priority(0), std::out_of_range);
+    BOOST_CHECK_THROW(q.change_priority(0, 0), std::out_of_range);
+    BOOST_CHECK(q.check_heap());
+    BOOST_CHECK(q.check_dirty());
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(deferred_updates)
+{
+    test_heap<> q(5);
+
+    for (unsigned short elem: {0,3,2,4,1})
+        BOOST_CHECK(q.push(elem, 10 + elem));
+
+    // recorded only
+    BOOST_CHECK(!q.push(3, 1));
+    BOOST_CHECK_EQUAL(q.size(), 5u);
+    BOOST_CHECK_EQUAL(q.pending_updates(), 5u);
+    BOOST_CHECK_EQUAL(q.get_priority(3), 13);
+    BOOST_CHECK(q.check_dirty());
+    BOOST_CHECK_THROW(q.get_priority(5), std::out_of_range);
+
+    BOOST_CHECK_EQUAL(q.top(), 0);
+    BOOST_CHECK_EQUAL(q.pending_updates(), 0u);
+    BOOST_CHECK(q.check_heap());
+    BOOST_CHECK(q.check_dirty());
+
+    // an element updated several times is applied once with its last priority
+    BOOST_CHECK(q.change_priority(4, 1));
+    BOOST_CHECK(q.change_priority(4, 30));
+    BOOST_CHECK(q.change_priority(4, 5));
+    BOOST_CHECK_EQUAL(q.pending_updates(), 1u);
+    BOOST_CHECK_EQUAL(q.get_priority(4), 5);
+    BOOST_CHECK_EQUAL(q.top(), 4);
+    BOOST_CHECK(q.check_heap());
+
+    q.pop();
+    q.set_priority(4, 12); // push again
+    q.set_priority(0, 20);
+    BOOST_CHECK_EQUAL(q.size(), 5u);
+    BOOST_CHECK(q.check_dirty());
+
+    for (unsigned short elem: {1,4,2,3,0})
+    {
+        BOOST_CHECK_EQUAL(q.top(), elem);
+        BOOST_CHECK_NO_THROW(q.pop());
+        BOOST_CHECK(q.check_heap());
+        BOOST_CHECK(q.check_dirty());
+    }
+
+    BOOST_CHECK(q.empty());
+    BOOST_CHECK(!q.change_priority(0, 1));
+}
+
+// =================================================================================================
+/// Few updates per pop take the sifting path, bursts the rebuild
+template<template<typename...> class container>
+void check_same_as_indexed_heap(unsigned updatesPerPop)
+{
+    const unsigned short n = 2000;
+    test_heap<container> q(n);
+    indexed_heap<unsigned short, int> reference(n);
+
+    std::mt19937 gen(38);
+    std::uniform_int_distribution<unsigned short> elems(0, n - 1);
+    std::uniform_int_distribution<int> prios(-100, 100);
+
+    for (unsigned round = 0; round < 200; ++round)
+    {
+        for (unsigned i = 0; i < updatesPerPop; ++i)
+        {
+            const auto elem = elems(gen);
+            const auto prio = prios(gen);
+            if (i % 3 == 0)
+            {
+                BOOST_REQUIRE_EQUAL(q.change_priority(elem, prio), reference.change_priority(elem, prio));
+            }
+            else
+            {
+                q.set_priority(elem, prio);
+                reference.set_priority(elem, prio);
+                BOOST_REQUIRE_EQUAL(q.get_priority(elem), prio);
+            }
+        }
+
+        BOOST_REQUIRE(q.check_dirty());
+        BOOST_REQUIRE_EQUAL(q.size(), reference.size());
+        BOOST_REQUIRE_EQUAL(q.top_priority(), reference.top_priority());
+        BOOST_REQUIRE(q.check_heap());
+
+        // equal priorities may be popped in any order
+        const auto elem = q.top();
+        BOOST_REQUIRE_EQUAL(reference.get_priority(elem), reference.top_priority());
+        q.pop();
+        reference.change_priority(elem, std::numeric_limits<int>::min());
+        reference.pop();
+    }
+
+    while (!q.empty())
+    {
+        BOOST_REQUIRE_EQUAL(q.top_priority(), reference.top_priority());
+        reference.change_priority(q.top(), std::numeric_limits<int>::min());
+        reference.pop();
+        q.pop();
+    }
+    BOOST_CHECK(reference.empty());
+}
+
+BOOST_AUTO_TEST_CASE(same_as_indexed_heap_sifting)
+{
+    check_same_as_indexed_heap<std::vector>(5);
+}
+
+BOOST_AUTO_TEST_CASE(same_as_indexed_heap_rebuild)
+{
+    check_same_as_indexed_heap<std::vector>(1000);
+}
+
+BOOST_AUTO_TEST_CASE(same_as_indexed_heap_segmented)
+{
+    check_same_as_indexed_heap<segmented_vector>(50);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(reserve_elements)
+{
+    test_heap<> q(2);
+    BOOST_CHECK(q.push(1, 5));
+    BOOST_CHECK_THROW(q.push(2, 1), std::out_of_range);
+
+    q.reserve_elements(4);
+    BOOST_CHECK_EQUAL(q.element_count(), 4u);
+    BOOST_CHECK(q.push(3, 1));
+    BOOST_CHECK(q.check_dirty());
+    BOOST_CHECK_EQUAL(q.top(), 3);
+    BOOST_CHECK_EQUAL(q.size(), 2u);
+}
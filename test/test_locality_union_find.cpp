@@ -0,0 +1,112 @@
+#include <locality_union_find.hpp>
+#include <union_find.hpp>
+#include "testing.hpp"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+using edge_list = std::vector<std::pair<unsigned, unsigned>>;
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(hash_linking)
+{
+    hash_linked_union_find<unsigned> uf(10);
+
+    BOOST_CHECK(uf.join(3, 7));
+    const auto root = hash_linked_union_find<unsigned>::link_priority(3) >
+        hash_linked_union_find<unsigned>::link_priority(7) ? 3u : 7u;
+    BOOST_CHECK_EQUAL(uf.find(3), root);
+    BOOST_CHECK_EQUAL(uf.find(7), root);
+    BOOST_CHECK(!uf.join(7, 3));
+    BOOST_CHECK_THROW(uf.join(0, 10), std::out_of_range);
+
+    // deterministic
+    BOOST_CHECK_EQUAL(hash_linked_union_find<unsigned>::link_priority(3),
+            hash_linked_union_find<int>::link_priority(3));
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(hash_linking_same_as_union_find)
+{
+    const unsigned n = 5000;
+    hash_linked_union_find<unsigned> uf(n);
+    union_find<unsigned> reference(n);
+
+    std::mt19937 gen(36);
+    std::uniform_int_distribution<unsigned> dist(0, n - 1);
+
+    for (unsigned i = 0; i < n; ++i)
+    {
+        const auto v1 = dist(gen);
+        const auto v2 = dist(gen);
+        BOOST_REQUIRE_EQUAL(uf.join(v1, v2), reference.join(v1, v2));
+    }
+
+    BOOST_CHECK_EQUAL(uf.count_disjoint(), reference.count_disjoint());
+    BOOST_CHECK_EQUAL(uf.count_singleton(), reference.count_singleton());
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(locality_order_bfs)
+{
+    // a path 9-2-7 and an edge 5-0; 9 has the only degree 2
+    const edge_list edges {{9, 2}, {7, 2}, {5, 0}, {2, 2}};
+    const auto order = locality_order<unsigned>(10, edges.begin(), edges.end());
+
+    BOOST_REQUIRE_EQUAL(order.size(), 10u);
+    BOOST_CHECK_EQUAL(order[2], 0u); // degree 4 with the self loop
+    BOOST_CHECK_EQUAL(std::min(order[9], order[7]), 1u);
+    BOOST_CHECK_EQUAL(std::max(order[9], order[7]), 2u);
+    BOOST_CHECK_EQUAL(std::min(order[5], order[0]), 3u);
+    BOOST_CHECK_EQUAL(std::max(order[5], order[0]), 4u);
+
+    // unconnected elements keep their order
+    BOOST_CHECK_EQUAL(order[1], 5u);
+    BOOST_CHECK_EQUAL(order[3], 6u);
+    BOOST_CHECK_EQUAL(order[4], 7u);
+    BOOST_CHECK_EQUAL(order[6], 8u);
+    BOOST_CHECK_EQUAL(order[8], 9u);
+
+    const edge_list bad {{1, 10}};
+    BOOST_CHECK_THROW(locality_order<unsigned>(10, bad.begin(), bad.end()), std::out_of_range);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(relabeled)
+{
+    BOOST_CHECK_THROW(relabeled_union_find<union_find<unsigned>>({0, 0}), std::invalid_argument);
+    BOOST_CHECK_THROW(relabeled_union_find<union_find<unsigned>>({0, 2}), std::invalid_argument);
+
+    const unsigned n = 5000;
+    std::mt19937 gen(360);
+    std::uniform_int_distribution<unsigned> dist(0, n - 1);
+
+    edge_list edges;
+    for (unsigned i = 0; i < n; ++i)
+        edges.emplace_back(dist(gen), dist(gen));
+
+    // order by a sample of the edges
+    relabeled_union_find<hash_linked_union_find<unsigned>> uf(
+            locality_order<unsigned>(n, edges.begin(), edges.begin() + n / 10));
+    union_find<unsigned> reference(n);
+
+    for (const auto& edge : edges)
+        BOOST_REQUIRE_EQUAL(uf.join(edge.first, edge.second), reference.join(edge.first, edge.second));
+
+    BOOST_CHECK_EQUAL(uf.size(), n);
+    BOOST_CHECK_EQUAL(uf.count_disjoint(), reference.count_disjoint());
+    BOOST_CHECK_EQUAL(uf.count_singleton(), reference.count_singleton());
+
+    const auto& cuf = uf;
+    for (unsigned v = 0; v < n; ++v)
+    {
+        // roots are reported as original values
+        BOOST_REQUIRE_EQUAL(uf.find(uf.find(v)), uf.find(v));
+        BOOST_REQUIRE_EQUAL(cuf.find(v), uf.find(v));
+        BOOST_REQUIRE_EQUAL(uf.find(v) == uf.find(edges[v].first), reference.find(v) == reference.find(edges[v].first));
+    }
+
+    BOOST_CHECK_THROW(uf.find(n), std::out_of_range);
+}
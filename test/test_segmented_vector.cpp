@@ -0,0 +1,67 @@
+#include <segmented_vector.hpp>
+#include "testing.hpp"
+
+#include <memory>
+
+using segments = segmented_vector<unsigned>;
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(empty)
+{
+    segments v;
+
+    BOOST_CHECK(v.empty());
+    BOOST_CHECK_EQUAL(v.size(), 0u);
+    BOOST_CHECK_EQUAL(v.capacity(), 0u);
+    BOOST_CHECK_THROW(v.at(0), std::out_of_range);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(grow_without_moving)
+{
+    segments v(10, 7);
+
+    BOOST_CHECK_EQUAL(v.size(), 10u);
+    BOOST_CHECK_EQUAL(v.capacity(), segments::segmentSize);
+    BOOST_CHECK_EQUAL(v.at(9), 7u);
+    BOOST_CHECK_THROW(v.at(10), std::out_of_range);
+
+    const unsigned* first = &v[0];
+    for (unsigned i = 10; i < 3 * segments::segmentSize + 5; ++i)
+        v.push_back(i);
+
+    // existing elements stay in place
+    BOOST_CHECK_EQUAL(&v[0], first);
+    BOOST_CHECK_EQUAL(v.size(), 3 * segments::segmentSize + 5);
+    BOOST_CHECK_EQUAL(v.capacity(), 4 * segments::segmentSize);
+    BOOST_CHECK_EQUAL(v.front(), 7u);
+    BOOST_CHECK_EQUAL(v.back(), 3 * segments::segmentSize + 4);
+    BOOST_CHECK_EQUAL(v[segments::segmentSize], segments::segmentSize);
+
+    v.pop_back();
+    BOOST_CHECK_EQUAL(v.back(), 3 * segments::segmentSize + 3);
+
+    v.resize(5);
+    BOOST_CHECK_EQUAL(v.size(), 5u);
+    v.resize(8);
+    BOOST_CHECK_EQUAL(v[7], 0u);
+
+    v.reserve(10 * segments::segmentSize);
+    BOOST_CHECK_EQUAL(v.size(), 8u);
+    BOOST_CHECK_EQUAL(v.capacity(), 10 * segments::segmentSize);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(move_only)
+{
+    segmented_vector<std::unique_ptr<int>> v(2);
+
+    BOOST_CHECK(!v[1]);
+    v.emplace_back(new int(3));
+    v.push_back(std::make_unique<int>(4));
+    v.resize(segments::segmentSize + 1);
+
+    BOOST_CHECK_EQUAL(*v[2], 3);
+    BOOST_CHECK_EQUAL(*v[3], 4);
+    BOOST_CHECK(!v.back());
+}
@@ -0,0 +1,142 @@
+#include <static_indexed_heap.hpp>
+#include <indexed_heap.hpp>
+#include "testing.hpp"
+
+#include <array>
+#include <random>
+
+namespace
+{
+    struct edge
+    {
+        unsigned char from;
+        unsigned char to;
+        int weight;
+    };
+
+    constexpr std::array<edge, 7> graph {{
+        {0, 1, 7}, {0, 2, 2}, {2, 1, 3}, {1, 3, 1}, {2, 3, 9}, {3, 4, 4}, {0, 4, 20}
+    }};
+
+    /// Dijkstra's shortest path on a tiny graph, evaluated at compile time
+    constexpr int shortest_path(unsigned char from, unsigned char to)
+    {
+        static_indexed_heap<unsigned char, int, 5> queue;
+        std::array<int, 5> distance {{-1, -1, -1, -1, -1}};
+
+        queue.push(from, 0);
+        while (!queue.empty())
+        {
+            const auto node = queue.top();
+            distance[node] = queue.top_priority();
+            queue.pop();
+
+            for (const auto& e : graph)
+            {
+                if (e.from != node || distance[e.to] >= 0)
+                    continue;
+                const int viaNode = distance[node] + e.weight;
+                if (queue.push(e.to, viaNode) || viaNode < queue.get_priority(e.to))
+                    queue.change_priority(e.to, viaNode);
+            }
+        }
+        return distance[to];
+    }
+
+    static_assert(shortest_path(0, 3) == 6, "");
+    static_assert(shortest_path(0, 4) == 10, "");
+    static_assert(shortest_path(3, 0) == -1, "");
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(zero_sized_heap)
+{
+    static_indexed_heap<unsigned short, int, 4> q(0);
+
+    BOOST_CHECK(q.empty());
+    BOOST_CHECK_EQUAL(q.size(), 0u);
+    BOOST_CHECK_NO_THROW(q.pop());
+    BOOST_CHECK_THROW(q.top(), std::out_of_range);
+    BOOST_CHECK_THROW(q.top_priority(), std::out_of_range);
+    BOOST_CHECK_THROW(q.push(0, 0), std::out_of_range);
+    BOOST_CHECK_THROW(q.get_priority(0), std::out_of_range);
+    BOOST_CHECK_THROW(q.change_priority(0, 0), std::out_of_range);
+
+    using heap_type = static_indexed_heap<unsigned short, int, 4>;
+    BOOST_CHECK_THROW(heap_type(5), std::length_error);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(push_pop_repriorize)
+{
+    static_indexed_heap<unsigned short, int, 16> q(5);
+
+    for (unsigned short elem: {0,3,2,4,1})
+        BOOST_CHECK(q.push(elem, 10 + elem));
+    BOOST_CHECK(!q.push(3, 0));
+    BOOST_CHECK_EQUAL(q.size(), 5u);
+
+    for (unsigned short elem: {0,3,2,4,1})
+        BOOST_CHECK(q.change_priority(elem, 10 - elem));
+
+    for (unsigned short elem: {4,3,2,1,0})
+    {
+        BOOST_CHECK_EQUAL(q.top(), elem);
+        BOOST_CHECK_EQUAL(q.top_priority(), 10 - elem);
+        BOOST_CHECK_EQUAL(q.get_priority(elem), 10 - elem);
+        BOOST_CHECK_NO_THROW(q.pop());
+    }
+
+    BOOST_CHECK(q.empty());
+    BOOST_CHECK_THROW(q.get_priority(0), std::out_of_range);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(same_as_indexed_heap)
+{
+    static_indexed_heap<unsigned char, int, 200> q;
+    indexed_heap<unsigned short, int> reference(200);
+
+    std::mt19937 gen(31);
+    std::uniform_int_distribution<unsigned> elemDist(0, 199);
+    std::uniform_int_distribution<int> prioDist(-1000, 1000);
+
+    for (unsigned i = 0; i < 10000; ++i)
+    {
+        if (i % 4 == 0 && !reference.empty())
+        {
+            BOOST_REQUIRE_EQUAL(q.top_priority(), reference.top_priority());
+            q.pop();
+            reference.pop();
+        }
+        else
+        {
+            const auto elem = static_cast<unsigned char>(elemDist(gen));
+            const auto prio = prioDist(gen);
+            q.set_priority(elem, prio);
+            reference.set_priority(elem, prio);
+        }
+
+        BOOST_REQUIRE_EQUAL(q.size(), reference.size());
+    }
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(full_element_range)
+{
+    // 255 elements of unsigned char, the positions stay below the invalid index 255
+    static_indexed_heap<unsigned char, int, 255> q;
+    BOOST_CHECK_EQUAL(q.capacity(), 255u);
+
+    for (unsigned elem = 0; elem < 255; ++elem)
+        BOOST_REQUIRE(q.push(static_cast<unsigned char>(elem), 254 - static_cast<int>(elem)));
+    BOOST_CHECK_EQUAL(q.size(), 255u);
+    BOOST_CHECK_THROW(q.push(255, 0), std::out_of_range);
+
+    for (unsigned elem = 255; elem-- > 0; )
+    {
+        BOOST_REQUIRE_EQUAL(q.top(), elem);
+        q.pop();
+    }
+    BOOST_CHECK(q.empty());
+}
@@ -0,0 +1,96 @@
+#include <static_union_find.hpp>
+#include <union_find.hpp>
+#include "testing.hpp"
+
+#include <random>
+
+namespace
+{
+    /// Number of components of a ring of n nodes where every 3rd edge is missing, at compile time
+    constexpr unsigned broken_ring_components(unsigned char n)
+    {
+        static_union_find<unsigned char, 64> uf(n);
+        for (unsigned char i = 0; i < n; ++i)
+        {
+            if (i % 3 != 2)
+                uf.join(i, (i + 1) % n);
+        }
+        return uf.count_disjoint();
+    }
+
+    static_assert(broken_ring_components(1) == 1, "");
+    static_assert(broken_ring_components(9) == 3, "");
+    static_assert(broken_ring_components(64) == 21, "");
+    static_assert(static_union_find<int, 16>(10).count_singleton() == 10, "");
+    static_assert(static_union_find<unsigned char, 256>().size() == 256, "");
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(capacity)
+{
+    static_union_find<int, 4> uf;
+    BOOST_CHECK_EQUAL(uf.size(), 4u);
+    BOOST_CHECK_EQUAL(uf.capacity(), 4u);
+    BOOST_CHECK_EQUAL(uf.max_value(), 3);
+
+    static_union_find<int, 4> empty(0);
+    BOOST_CHECK_EQUAL(empty.size(), 0u);
+    BOOST_CHECK_EQUAL(empty.count_disjoint(), 0u);
+    BOOST_CHECK_THROW(empty.find(0), std::out_of_range);
+
+    BOOST_CHECK_THROW((static_union_find<int, 4>(5)), std::length_error);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(size_two)
+{
+    static_union_find<int, 8> uf(2);
+
+    BOOST_CHECK_THROW(uf.find_opt(-1), std::out_of_range);
+    BOOST_CHECK_EQUAL(uf.find_opt(0), 0);
+    BOOST_CHECK_EQUAL(uf.find_opt(1), 1);
+    BOOST_CHECK_THROW(uf.find_opt(2), std::out_of_range);
+
+    BOOST_CHECK(!uf.join(0, 0));
+    BOOST_CHECK(uf.join(0, 1));
+    BOOST_CHECK(!uf.join(0, 1));
+    BOOST_CHECK_THROW(uf.join(0, 2), std::out_of_range);
+
+    BOOST_CHECK_EQUAL(uf.find_opt(0), uf.find_opt(1));
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(same_as_union_find)
+{
+    static_union_find<unsigned char, 255> uf;
+    union_find<unsigned char> reference(255);
+
+    std::mt19937 gen(31);
+    std::uniform_int_distribution<unsigned> dist(0, 254);
+
+    for (unsigned i = 0; i < 200; ++i)
+    {
+        const auto v1 = static_cast<unsigned char>(dist(gen));
+        const auto v2 = static_cast<unsigned char>(dist(gen));
+        BOOST_REQUIRE_EQUAL(uf.join(v1, v2), reference.join(v1, v2));
+        BOOST_REQUIRE_EQUAL(uf.count_disjoint(), reference.count_disjoint());
+        BOOST_REQUIRE_EQUAL(uf.count_singleton(), reference.count_singleton());
+        BOOST_REQUIRE_EQUAL(uf.find(v1), reference.find(v1));
+    }
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(full_value_range)
+{
+    // every unsigned char, the counts need a wider type than the values
+    static_union_find<unsigned char, 256> uf;
+    BOOST_CHECK_EQUAL(uf.size(), 256u);
+    BOOST_CHECK_EQUAL(uf.max_value(), 255);
+    BOOST_CHECK_EQUAL(uf.count_disjoint(), 256u);
+
+    for (unsigned value = 1; value < 256; ++value)
+        BOOST_REQUIRE(uf.join(0, static_cast<unsigned char>(value)));
+    BOOST_CHECK_EQUAL(uf.count_disjoint(), 1u);
+    BOOST_CHECK_EQUAL(uf.find(255), uf.find(0));
+    BOOST_CHECK_THROW((static_union_find<unsigned char, 256>(257)), std::length_error);
+}
@@ -0,0 +1,148 @@
+#include <streaming_components.hpp>
+#include <compact_union_find.hpp>
+#include <union_find.hpp>
+#include "testing.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    /// Generates a random edge file on local disk and removes it at the end of the test
+    template<typename T>
+    class edge_file
+    {
+        public:
+            edge_file(const std::string& path, T nodeCount, size_t edgeCount, unsigned seed)
+                : mPath(path)
+            {
+                std::mt19937 gen(seed);
+                std::uniform_int_distribution<T> dist(0, nodeCount - 1);
+
+                for (size_t e = 0; e < edgeCount; ++e)
+                    mEdges.emplace_back(dist(gen), dist(gen));
+
+                write(2 * edgeCount);
+            }
+
+            ~edge_file()
+            { std::remove(mPath.c_str()); }
+
+            /// Writes the first valueCount values of the edges, then strayBytes zero bytes
+            void write(size_t valueCount, size_t strayBytes = 0) const
+            {
+                std::FILE* file = std::fopen(mPath.c_str(), "wb");
+                BOOST_REQUIRE(file);
+                for (size_t v = 0; v < valueCount; ++v)
+                {
+                    const auto& edge = mEdges[v / 2];
+                    const T value = v % 2 ? edge.second : edge.first;
+                    std::fwrite(&value, sizeof(value), 1, file);
+                }
+                for (size_t b = 0; b < strayBytes; ++b)
+                    std::fputc(0, file);
+                std::fclose(file);
+            }
+
+            const std::string& path() const
+            { return mPath; }
+
+            const std::vector<std::pair<T, T>>& edges() const
+            { return mEdges; }
+
+        private:
+            std::string mPath;
+            std::vector<std::pair<T, T>> mEdges;
+    };
+
+    template<typename union_find_type, typename T>
+    void check_same_partition(union_find_type& uf, union_find<T>& reference)
+    {
+        BOOST_REQUIRE_EQUAL(uf.size(), reference.size());
+        BOOST_CHECK_EQUAL(uf.count_disjoint(), reference.count_disjoint());
+        BOOST_CHECK_EQUAL(uf.count_singleton(), reference.count_singleton());
+
+        // every root of the reference maps to one root of uf, with equal set counts the mapping is
+        // a bijection
+        std::vector<int64_t> rootInUf(reference.size(), -1);
+        for (T v = 0; v < reference.size(); ++v)
+        {
+            auto& mapped = rootInUf[static_cast<size_t>(reference.find(v))];
+            const auto root = static_cast<int64_t>(uf.find(v));
+            if (mapped == -1)
+                mapped = root;
+            BOOST_REQUIRE_EQUAL(mapped, root);
+        }
+    }
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(empty_file)
+{
+    edge_file<unsigned> file("test_streaming_components_empty.edges", 10, 0, 1);
+    union_find<unsigned> uf(10);
+
+    BOOST_CHECK_NO_THROW(stream_components(uf, file.path()));
+    BOOST_CHECK_EQUAL(uf.count_singleton(), 10u);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(same_as_in_memory_join)
+{
+    const unsigned nodes = 20000;
+    edge_file<unsigned> file("test_streaming_components.edges", nodes, 15000, 27);
+
+    union_find<unsigned> reference(nodes);
+    for (const auto& edge : file.edges())
+        reference.join(edge.first, edge.second);
+
+    // chunk sizes: partial last chunk, exact multiple, single chunk
+    for (size_t chunkEdges : {size_t(997), size_t(1000), size_t(1) << 20})
+    {
+        union_find<unsigned> uf(nodes);
+        stream_components(uf, file.path(), chunkEdges);
+        check_same_partition(uf, reference);
+    }
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(compact_union_find_target)
+{
+    const uint64_t nodes = 30000;
+    edge_file<uint64_t> file("test_streaming_components_64.edges", nodes, 20000, 270);
+
+    union_find<uint64_t> reference(nodes);
+    for (const auto& edge : file.edges())
+        reference.join(edge.first, edge.second);
+
+    compact_union_find<> uf(nodes);
+    stream_components(uf, file.path(), 4096);
+    check_same_partition(uf, reference);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(errors)
+{
+    union_find<unsigned> uf(100);
+
+    BOOST_CHECK_THROW(stream_components(uf, "test_streaming_components.missing"), std::runtime_error);
+
+    edge_file<unsigned> file("test_streaming_components_bad.edges", 100, 10, 2);
+    BOOST_CHECK_THROW(stream_components(uf, file.path(), 0), std::invalid_argument);
+
+    file.write(7);
+    BOOST_CHECK_THROW(stream_components(uf, file.path(), 2), std::runtime_error);
+
+    // whole edges followed by a partial value
+    file.write(4, 3);
+    BOOST_CHECK_THROW(stream_components(uf, file.path()), std::runtime_error);
+    file.write(4, sizeof(unsigned));
+    BOOST_CHECK_THROW(stream_components(uf, file.path(), 2), std::runtime_error);
+
+    union_find<unsigned> small(10);
+    file.write(20);
+    BOOST_CHECK_THROW(stream_components(small, file.path()), std::out_of_range);
+}
@@ -1,6 +1,12 @@
 #include <union_find.hpp>
+#include <segmented_vector.hpp>
 #include "testing.hpp"
 
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <vector>
+
 // =================================================================================================
 BOOST_AUTO_TEST_SUITE(interface_test)
 
@@ -95,6 +101,60 @@ BOOST_AUTO_TEST_CASE(count_singleton)
     BOOST_CHECK_EQUAL(uf.count_singleton(), 0);
 }
 
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(find_batch)
+{
+    union_find<int> uf(100);
+    for (int i = 0; i + 3 < 100; i += 3)
+        uf.join(i, i + 3);
+    for (int i = 1; i < 100; i += 7)
+        uf.join(i, 1);
+
+    std::vector<int> values;
+    for (int i = 99; i >= 0; --i)
+        values.push_back(i);
+    values.insert(values.end(), {5, 5, 0, 99});
+
+    std::vector<int> roots;
+    uf.find_batch(values.begin(), values.end(), std::back_inserter(roots));
+
+    BOOST_REQUIRE_EQUAL(roots.size(), values.size());
+    const auto& cuf = uf;
+    for (size_t i = 0; i < values.size(); ++i)
+        BOOST_CHECK_EQUAL(roots[i], cuf.find(values[i]));
+
+    std::vector<int> none;
+    BOOST_CHECK(uf.find_batch(none.begin(), none.end(), roots.begin()) == roots.begin());
+
+    values[20] = 100;
+    BOOST_CHECK_THROW(uf.find_batch(values.begin(), values.end(), roots.begin()), std::out_of_range);
+    values[20] = -1;
+    BOOST_CHECK_THROW(uf.find_batch(values.begin(), values.end(), roots.begin()), std::out_of_range);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(same_set_batch)
+{
+    union_find<unsigned> uf(64);
+    for (unsigned i = 0; i + 2 < 64; i += 2)
+        uf.join(i, i + 2);
+
+    std::vector<unsigned> a, b;
+    for (unsigned i = 0; i < 64; ++i)
+    {
+        a.push_back(i);
+        b.push_back((i * 7) % 64);
+    }
+
+    std::vector<bool> same(a.size());
+    BOOST_CHECK(uf.same_set_batch(a.begin(), a.end(), b.begin(), same.begin()) == same.end());
+    for (size_t i = 0; i < a.size(); ++i)
+        BOOST_CHECK_EQUAL(same[i], uf.find(a[i]) == uf.find(b[i]));
+
+    b[40] = 64;
+    BOOST_CHECK_THROW(uf.same_set_batch(a.begin(), a.end(), b.begin(), same.begin()), std::out_of_range);
+}
+
 // =================================================================================================
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -541,3 +601,286 @@ BOOST_AUTO_TEST_CASE(resize_expand)
 
 // =================================================================================================
 BOOST_AUTO_TEST_SUITE_END()
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(segmented_storage)
+{
+    union_find<unsigned, segmented_vector> uf(8);
+    union_find<unsigned> reference(8);
+
+    for (unsigned n : {8u, 1000u, 70000u, 200000u})
+    {
+        uf.resize(n);
+        reference.resize(n);
+        BOOST_REQUIRE_EQUAL(uf.size(), n);
+
+        for (unsigned i = 0; i + 7 < n; i += 7)
+        {
+            uf.join(i, i + 7);
+            reference.join(i, i + 7);
+        }
+
+        BOOST_CHECK_EQUAL(uf.count_disjoint(), reference.count_disjoint());
+        BOOST_CHECK_EQUAL(uf.count_singleton(), reference.count_singleton());
+        BOOST_CHECK_EQUAL(uf.find(n - 1), reference.find(n - 1));
+    }
+
+    BOOST_CHECK_THROW(uf.resize(10), std::out_of_range);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(counting_empty)
+{
+    // the counting loops must not depend on max_value(), which wraps around for no values
+    union_find<unsigned> uf(0);
+    BOOST_CHECK_EQUAL(uf.count_disjoint(), 0u);
+    BOOST_CHECK_EQUAL(uf.count_singleton(), 0u);
+    BOOST_CHECK_EQUAL(uf.count_disjoint(4), 0u);
+    BOOST_CHECK_EQUAL(uf.count_singleton(4), 0u);
+
+    union_find<int> signedUf(0);
+    BOOST_CHECK_EQUAL(signedUf.count_disjoint(), 0u);
+    BOOST_CHECK_EQUAL(signedUf.count_singleton(), 0u);
+}
+
+// =================================================================================================
+#ifdef ROOT_SCAN_X86
+/// The SSE2 kernels are only used on CPUs without AVX2, checked directly by element size
+template<typename T, typename S, size_t elementSize>
+void check_sse2_kernels(const T*, const S*, size_t, size_t, std::integral_constant<size_t, elementSize>)
+{}
+
+template<typename T, typename S>
+void check_sse2_kernels(const T* sets, const S* sizes, size_t first, size_t count, std::integral_constant<size_t, 4>)
+{
+    BOOST_REQUIRE_EQUAL((root_scan::detail::count_sse2_32<false>(sets, sizes, first, count)), root_scan::count_roots_scalar(sets, first, count));
+    BOOST_REQUIRE_EQUAL((root_scan::detail::count_sse2_32<true>(sets, sizes, first, count)), root_scan::count_singletons_scalar(sets, sizes, first, count));
+}
+
+template<typename T, typename S>
+void check_sse2_kernels(const T* sets, const S* sizes, size_t first, size_t count, std::integral_constant<size_t, 8>)
+{
+    BOOST_REQUIRE_EQUAL((root_scan::detail::count_sse2_64<false>(sets, sizes, first, count)), root_scan::count_roots_scalar(sets, first, count));
+    BOOST_REQUIRE_EQUAL((root_scan::detail::count_sse2_64<true>(sets, sizes, first, count)), root_scan::count_singletons_scalar(sets, sizes, first, count));
+}
+#endif
+
+template<typename T>
+void check_root_scan_kernels()
+{
+    using S = std::make_unsigned_t<T>;
+    std::mt19937 gen(39);
+
+    for (size_t count = 0; count < 70; ++count)
+    {
+        for (size_t first : {size_t(0), size_t(5), size_t(1000003)})
+        {
+            std::vector<T> sets(count);
+            std::vector<S> sizes(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                sets[i] = static_cast<T>(gen() % 3 ? first + i : first + i + 1);
+                sizes[i] = static_cast<S>(1 + gen() % 2);
+            }
+
+            // unaligned starts too
+            for (size_t offset = 0; offset < std::min<size_t>(count, 3); ++offset)
+            {
+                BOOST_REQUIRE_EQUAL(root_scan::count_roots(sets.data() + offset, first + offset, count - offset),
+                        root_scan::count_roots_scalar(sets.data() + offset, first + offset, count - offset));
+                BOOST_REQUIRE_EQUAL(root_scan::count_singletons(sets.data() + offset, sizes.data() + offset, first + offset, count - offset),
+                        root_scan::count_singletons_scalar(sets.data() + offset, sizes.data() + offset, first + offset, count - offset));
+
+#ifdef ROOT_SCAN_X86
+                check_sse2_kernels(sets.data() + offset, sizes.data() + offset, first + offset, count - offset,
+                        std::integral_constant<size_t, sizeof(T)>());
+#endif
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(root_scan_kernels)
+{
+    check_root_scan_kernels<unsigned char>();
+    check_root_scan_kernels<unsigned short>();
+    check_root_scan_kernels<int>();
+    check_root_scan_kernels<unsigned>();
+    check_root_scan_kernels<long long>();
+    check_root_scan_kernels<uint64_t>();
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(count_parallel)
+{
+    // the split covers every value exactly once
+    for (size_t n : {0, 1, 63, 64, 1000, 4097})
+    {
+        for (unsigned threads : {1, 2, 3, 8})
+        {
+            const size_t sum = root_scan::count_parallel(n, threads,
+                    [](size_t first, size_t last) { return last * (last - 1) / 2 - (first ? first * (first - 1) / 2 : 0); }, 16);
+            BOOST_REQUIRE_EQUAL(sum, n ? n * (n - 1) / 2 : 0);
+        }
+    }
+
+    const unsigned n = 3 << 20;
+    union_find<unsigned> uf(n);
+    union_find<unsigned, segmented_vector> segmented(n);
+    for (unsigned i = 0; i + 5 < n; i += 3)
+    {
+        uf.join(i, i + 5);
+        segmented.join(i, i + 5);
+    }
+
+    const auto disjoint = uf.count_disjoint();
+    const auto singletons = uf.count_singleton();
+    BOOST_CHECK_EQUAL(segmented.count_disjoint(), disjoint);
+    BOOST_CHECK_EQUAL(segmented.count_singleton(), singletons);
+
+    for (unsigned threads : {0, 1, 2, 3})
+    {
+        BOOST_CHECK_EQUAL(uf.count_disjoint(threads), disjoint);
+        BOOST_CHECK_EQUAL(uf.count_singleton(threads), singletons);
+        BOOST_CHECK_EQUAL(segmented.count_disjoint(threads), disjoint);
+        BOOST_CHECK_EQUAL(segmented.count_singleton(threads), singletons);
+    }
+}
+
+// =================================================================================================
+namespace
+{
+    /// Whether two union-finds partition their values the same way
+    template<typename A, typename B>
+    bool same_partition(const A& a, const B& b)
+    {
+        if (a.size() != b.size())
+            return false;
+
+        std::vector<int64_t> rootInB(a.size(), -1);
+        for (size_t v = 0; v < a.size(); ++v)
+        {
+            auto& mapped = rootInB[static_cast<size_t>(a.find(static_cast<typename A::value_type>(v)))];
+            const auto root = static_cast<int64_t>(b.find(static_cast<typename B::value_type>(v)));
+            if (mapped == -1)
+                mapped = root;
+            else if (mapped != root)
+                return false;
+        }
+        return a.count_disjoint() == b.count_disjoint();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(merge_shards)
+{
+    const unsigned n = 5000;
+    std::mt19937 gen(43);
+    std::uniform_int_distribution<unsigned> values(0, n - 1);
+
+    // every shard joins a slice of the edges, merging them equals replaying all edges
+    union_find<unsigned> replayed(n);
+    std::vector<union_find<unsigned>> shards;
+    for (unsigned shard = 0; shard < 8; ++shard)
+    {
+        shards.emplace_back(n - shard * 100); // smaller shards grow the merged one
+        for (unsigned edge = 0; edge < 300; ++edge)
+        {
+            const unsigned a = values(gen) % shards.back().size();
+            const unsigned b = values(gen) % shards.back().size();
+            shards.back().join(a, b);
+            replayed.join(a, b);
+        }
+    }
+
+    union_find<unsigned> merged(10);
+    for (const auto& shard : shards)
+        merged.merge(shard);
+    BOOST_CHECK(same_partition(merged, replayed));
+
+    // merging is idempotent
+    merged.merge(shards.front());
+    merged.merge(merged);
+    BOOST_CHECK(same_partition(merged, replayed));
+
+    // pairwise tree reduction through root maps
+    std::vector<std::vector<uint8_t>> maps;
+    for (const auto& shard : shards)
+        maps.push_back(shard.root_map());
+    while (maps.size() > 1)
+    {
+        std::vector<std::vector<uint8_t>> reduced;
+        for (size_t i = 0; i < maps.size(); i += 2)
+        {
+            union_find<unsigned> pair(0);
+            pair.merge_root_map(maps[i]);
+            if (i + 1 < maps.size())
+                pair.merge_root_map(maps[i + 1]);
+            reduced.push_back(pair.root_map());
+        }
+        maps.swap(reduced);
+    }
+
+    union_find<unsigned> fromMap(0);
+    fromMap.merge_root_map(maps.front());
+    BOOST_CHECK(same_partition(fromMap, replayed));
+
+    // decoded without joins into one level trees
+    const auto decoded = union_find<unsigned>::from_root_map(maps.front());
+    BOOST_CHECK(same_partition(decoded, replayed));
+    BOOST_CHECK(decoded.root_map() == maps.front());
+    BOOST_CHECK_EQUAL(decoded.count_singleton(), replayed.count_singleton());
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(root_map_format)
+{
+    // singletons take no space
+    BOOST_CHECK((union_find<unsigned>(0).root_map() == std::vector<uint8_t>{0, 0}));
+    BOOST_CHECK((union_find<unsigned>(300).root_map() == std::vector<uint8_t>{0xac, 0x02, 0}));
+
+    union_find<unsigned short> uf(200);
+    uf.join(3, 7);
+    uf.join(150, 3);
+    const auto map = uf.root_map();
+    BOOST_CHECK_EQUAL(map[2], 2u); // after the 2-byte size: two values that are not roots
+    BOOST_CHECK_LE(map.size(), 3u + 2u * (1u + 2u));
+
+    union_find<unsigned short> copy(50);
+    copy.join(0, 1);
+    copy.merge_root_map(map);
+    BOOST_CHECK_EQUAL(copy.size(), 200u);
+    BOOST_CHECK_EQUAL(copy.find(150), copy.find(7));
+    BOOST_CHECK_EQUAL(copy.find(0), copy.find(1));
+    BOOST_CHECK_EQUAL(copy.count_disjoint(), 200u - 3u);
+
+    // truncated, values out of range, more entries than values, trailing bytes, overlong varint
+    union_find<unsigned short> target(10);
+    for (size_t length = 0; length < map.size(); ++length)
+        BOOST_CHECK_THROW(target.merge_root_map(map.data(), length), std::invalid_argument);
+    BOOST_CHECK_THROW(target.merge_root_map({5, 1, 2, 9}), std::invalid_argument);
+    BOOST_CHECK_THROW(target.merge_root_map({5, 1, 5, 0}), std::invalid_argument);
+    BOOST_CHECK_THROW(target.merge_root_map({2, 3, 0, 1, 0, 1, 0, 1}), std::invalid_argument);
+    BOOST_CHECK_THROW(target.merge_root_map({5, 0, 0}), std::invalid_argument);
+    BOOST_CHECK_THROW(target.merge_root_map(std::vector<uint8_t>(11, 0x80)), std::invalid_argument);
+    BOOST_CHECK_THROW(target.merge_root_map({0xff, 0xff, 0x04, 0}), std::invalid_argument); // exceeds unsigned short
+    BOOST_CHECK_EQUAL(target.size(), 10u); // nothing grew or joined on errors
+    BOOST_CHECK_EQUAL(target.count_disjoint(), 10u);
+    BOOST_CHECK_NO_THROW(target.merge_root_map({5, 1, 2, 4}));
+
+    // a corrupted size of 2^32 - 1 fails on the entries before anything is allocated
+    union_find<unsigned> wide(10);
+    BOOST_CHECK_THROW(wide.merge_root_map({0xff, 0xff, 0xff, 0xff, 0x0f, 1, 0}), std::invalid_argument);
+    BOOST_CHECK_THROW(union_find<unsigned>::from_root_map({0xff, 0xff, 0xff, 0xff, 0x0f, 2, 0, 1}), std::invalid_argument);
+    BOOST_CHECK_EQUAL(wide.size(), 10u);
+
+    // from_root_map() also rejects maps that are not one level trees
+    BOOST_CHECK_THROW(union_find<unsigned short>::from_root_map({3, 2, 0, 1, 0, 2}), std::invalid_argument);
+    BOOST_CHECK_THROW(union_find<unsigned short>::from_root_map({3, 2, 1, 0, 0, 1}), std::invalid_argument);
+    BOOST_CHECK_THROW(union_find<unsigned short>::from_root_map({3, 1, 1, 1}), std::invalid_argument);
+    BOOST_CHECK_THROW(union_find<unsigned short>::from_root_map(map.data(), map.size() - 1), std::invalid_argument);
+    const auto decoded = union_find<unsigned short>::from_root_map(map);
+    BOOST_CHECK_EQUAL(decoded.find(150), decoded.find(3));
+    BOOST_CHECK_EQUAL(decoded.find(7), decoded.find(3));
+    BOOST_CHECK_EQUAL(decoded.count_disjoint(), 200u - 2u);
+    BOOST_CHECK_EQUAL(target.find(2), target.find(4));
+}
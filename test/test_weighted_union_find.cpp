@@ -0,0 +1,109 @@
+#include <weighted_union_find.hpp>
+#include "testing.hpp"
+
+#include <random>
+#include <vector>
+
+using wuf = weighted_union_find<int, long>;
+using join_result = wuf::join_result;
+using fwuf = weighted_union_find<int, double>;
+using fjoin_result = fwuf::join_result;
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(zero_sized)
+{
+    wuf uf(0);
+
+    BOOST_CHECK_THROW(uf.find(0), std::out_of_range);
+    BOOST_CHECK_THROW(uf.join(0, 1, 0), std::out_of_range);
+    BOOST_CHECK_THROW(uf.diff(0, 0), std::out_of_range);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(clock_skew)
+{
+    // 0: reference clock, 1-3: log sources with known pairwise offsets, 4: unrelated
+    wuf uf(5);
+
+    BOOST_CHECK(uf.join(0, 1, 5) == join_result::joined);   // t1 = t0 + 5
+    BOOST_CHECK(uf.join(2, 1, -3) == join_result::joined);  // t1 = t2 - 3
+    BOOST_CHECK(uf.join(3, 2, 10) == join_result::joined);  // t2 = t3 + 10
+
+    BOOST_CHECK_EQUAL(uf.diff(0, 1), 5);
+    BOOST_CHECK_EQUAL(uf.diff(1, 0), -5);
+    BOOST_CHECK_EQUAL(uf.diff(0, 2), 8);
+    BOOST_CHECK_EQUAL(uf.diff(0, 3), -2);
+    BOOST_CHECK_EQUAL(uf.diff(3, 3), 0);
+
+    BOOST_CHECK(uf.join(3, 0, 2) == join_result::consistent);
+    BOOST_CHECK(uf.join(3, 0, 3) == join_result::conflict);
+    BOOST_CHECK_EQUAL(uf.diff(3, 0), 2);
+
+    BOOST_CHECK(!uf.same_set(0, 4));
+    BOOST_CHECK_THROW(uf.diff(0, 4), std::invalid_argument);
+    const auto& cuf = uf;
+    BOOST_CHECK_THROW(cuf.diff(4, 0), std::invalid_argument);
+    BOOST_CHECK_EQUAL(cuf.diff(1, 3), -7);
+    BOOST_CHECK_EQUAL(uf.count_disjoint(), 2u);
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(random_potentials)
+{
+    const int n = 2000;
+    wuf uf(n);
+
+    std::mt19937 gen(32);
+    std::uniform_int_distribution<int> valueDist(0, n - 1);
+    std::uniform_int_distribution<long> potentialDist(-1000000, 1000000);
+
+    std::vector<long> potential(n);
+    for (auto& p : potential)
+        p = potentialDist(gen);
+
+    for (int i = 0; i < 3 * n; ++i)
+    {
+        const int v1 = valueDist(gen);
+        const int v2 = valueDist(gen);
+        const bool joined = !uf.same_set(v1, v2);
+
+        const auto result = uf.join(v1, v2, potential[v2] - potential[v1]);
+        BOOST_REQUIRE(result == (joined ? join_result::joined : join_result::consistent));
+        if (v1 != v2)
+            BOOST_REQUIRE(uf.join(v1, v2, potential[v2] - potential[v1] + 1) == join_result::conflict);
+
+        // const queries walk the uncompressed paths
+        const int v3 = valueDist(gen);
+        const auto& cuf = uf;
+        if (cuf.find(v1) == cuf.find(v3))
+            BOOST_REQUIRE_EQUAL(cuf.diff(v1, v3), potential[v3] - potential[v1]);
+    }
+
+    for (int v = 0; v < n; ++v)
+    {
+        if (uf.same_set(0, v))
+            BOOST_REQUIRE_EQUAL(uf.diff(0, v), potential[v] - potential[0]);
+    }
+}
+
+// =================================================================================================
+BOOST_AUTO_TEST_CASE(floating_point_tolerance)
+{
+    // a chain of 0.1 steps, the potentials are sums of rounded differences
+    const int n = 1000;
+    fwuf uf(n);
+    for (int i = 1; i < n; ++i)
+        BOOST_REQUIRE(uf.join(i - 1, i, 0.1) == fjoin_result::joined);
+
+    const double span = 0.1 * (n - 1);
+    BOOST_CHECK(uf.diff(0, n - 1) != span); // not exact
+    BOOST_CHECK(uf.join(0, n - 1, span) == fjoin_result::consistent);
+    BOOST_CHECK(uf.join(n - 1, 0, -span) == fjoin_result::consistent);
+    BOOST_CHECK(uf.join(0, n - 1, span + 1e-6) == fjoin_result::conflict);
+
+    // exact comparison on request
+    fwuf exact(3, 0.0);
+    exact.join(0, 1, 0.1);
+    exact.join(1, 2, 0.2);
+    BOOST_CHECK(exact.join(0, 2, 0.3) == fjoin_result::conflict);
+}